@@ -2,42 +2,76 @@
 #define ACCOUNT_H
 
 #include <string>
-#include <vector>
+#include <string_view>
 #include "Money.h"
-#include "Transaction.h"
+#include "Ledger.h"
+#include "RingBuffer.h"
+#include "StringPool.h"
+#include "TransactionResult.h"
 
+// An account's text lives in a StringPool shared with its neighbours, so
+// the record itself is fixed-width: the numeric fields a balance scan reads
+// come first, followed by four pool ids. The pool must outlive the account.
 class Account {
 public:
-    Account(const std::string& owner, const std::string& id, const Money& minimumBalance, const Money& initialBalance);
-    
-    std::string getOwner() const;
-    std::string getID() const;
+    using History = PostingView;
+
+    static constexpr size_t kDefaultHistoryCapacity = 64;
+
+    Account(StringPool& strings, std::string_view owner, std::string_view id,
+            const Money& minimumBalance, const Money& initialBalance);
+    Account(const Account&) = delete;
+    Account& operator=(const Account&) = delete;
+
+    // Views into the pool; valid while the pool is.
+    std::string_view getOwner() const;
+    std::string_view getID() const;
     Money getCurrent() const;
     Money getMinimum() const;
-    std::string getEmail() const;
-    std::string getPassword() const;
+    std::string_view getEmail() const;
+    const std::string& getPassword() const;
     bool isAdmin() const;
 
-    void setEmail(const std::string& email);
+    void setEmail(std::string_view email);
     void setPassword(const std::string& password);
     void setIsAdmin(bool admin);
 
+    // Applies amount unless it is a debit that would take the balance below
+    // the minimum (and force is false) or it would overflow. Never throws and
+    // never copies; a rejection leaves the balance untouched.
+    TransactionResult tryAdjust(const Money& amount, bool force = false) noexcept;
+    // Throwing form of tryAdjust: OverdraftException or std::overflow_error.
     void adjust(const Money& amount, bool force = false);
-    void addTransaction(const Transaction& transaction);
-    std::vector<Transaction> getLastTransactions(int count) const;
-    std::string getUsername() const;
-    void setUsername(const std::string& newUsername);
+    // Records a ledger row that touches this account in its history window.
+    void addPosting(uint32_t row);
+    // The newest count postings, oldest first. The view is invalidated by the
+    // next addPosting or setHistoryCapacity on this account.
+    History getLastTransactions(int count) const;
+    size_t getHistoryCapacity() const;
+    void setHistoryCapacity(size_t capacity);
+    std::string_view getUsername() const;
+    void setUsername(std::string_view newUsername);
+
+    // Set by the Bank that opens the account; detached accounts keep no history.
+    void attachLedger(Ledger* ledger, uint32_t handle);
+    Ledger* getLedger() const;
+    uint32_t getHandle() const;
 
 private:
-    std::string username;
-    std::string owner;
-    std::string id;
-    Money minimum;
+    enum Flag : uint32_t { AdminFlag = 1 };
+
     Money current;
-    std::string email;
+    Money minimum;
+    uint32_t handle;
+    uint32_t flags;
+    StringPool::Id id;
+    StringPool::Id owner;
+    StringPool::Id username;
+    StringPool::Id email;
+    StringPool* strings;
+    Ledger* ledger;
     std::string password;
-    bool admin;
-    std::vector<Transaction> transactions;
+    RingBuffer<uint32_t> postings;
 };
 
 #endif // ACCOUNT_H
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef ACCOUNT_INDEX_H
+#define ACCOUNT_INDEX_H
+
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+class Account;
+
+// Open-addressing hash index from one of an Account's string fields to the
+// account's slot in Bank's account vector. The index stores only the hash and
+// the slot, and resolves candidates through the accounts themselves, so a
+// lookup never copies or allocates a key.
+class AccountIndex {
+public:
+    using KeyOf = std::string_view (Account::*)() const;
+    using Accounts = std::deque<Account>;
+
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    explicit AccountIndex(KeyOf keyOf);
+
+    uint32_t find(std::string_view key, const Accounts& accounts) const;
+    bool contains(std::string_view key, const Accounts& accounts) const;
+
+    // Callers check contains() first; insert() does not look for duplicates.
+    void insert(uint32_t slot, const Accounts& accounts);
+    void erase(std::string_view key, const Accounts& accounts);
+    void reserve(size_t count);
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t slot;
+    };
+
+    KeyOf keyOf;
+    std::vector<Entry> entries;
+    size_t size;
+
+    static uint32_t hashOf(std::string_view key);
+    void place(Entry entry);
+    void rehash(size_t capacity);
+};
+
+#endif // ACCOUNT_INDEX_H
@@ -0,0 +1,100 @@
+#ifndef ACCOUNT_SNAPSHOT_H
+#define ACCOUNT_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Money.h"
+
+class Account;
+class Bank;
+class StringPool;
+
+// Read-only view of a snapshot file of accounts, mapped into memory. The
+// file is a fixed header followed by flat columns (balances, minimums,
+// flags, string offsets), a row order sorted by id, and one string table,
+// so opening costs one mmap regardless of the account count and every
+// accessor reads straight from the mapping. Nothing is copied or allocated
+// until a row is materialized.
+//
+// sequence() is whatever the writer passed in (a journal position or a
+// change-log number); changes after it are applied on top by the caller.
+// Snapshots use the host's byte order and are rejected on a mismatch.
+class AccountSnapshot {
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    // Throws std::runtime_error if the file is missing, truncated or not a
+    // snapshot. The body checksum is left to verify().
+    explicit AccountSnapshot(const std::string& path);
+    ~AccountSnapshot();
+
+    AccountSnapshot(const AccountSnapshot&) = delete;
+    AccountSnapshot& operator=(const AccountSnapshot&) = delete;
+
+    uint64_t sequence() const;
+    size_t size() const;
+
+    std::string_view id(size_t row) const;
+    std::string_view owner(size_t row) const;
+    std::string_view username(size_t row) const;
+    std::string_view email(size_t row) const;
+    Money balance(size_t row) const;
+    Money minimum(size_t row) const;
+    bool isAdmin(size_t row) const;
+
+    // Binary search over the id order; npos if absent.
+    size_t find(std::string_view id) const;
+    // Checksums the whole body, so it reads every page of the file.
+    bool verify() const;
+    // A standalone Account for one row (no ledger, no password), with its
+    // text interned in strings.
+    std::unique_ptr<Account> materialize(size_t row, StringPool& strings) const;
+
+    // Collects accounts and writes them as a snapshot. The file is written
+    // beside path and renamed over it, so readers see the old or new
+    // snapshot, never a partial one.
+    class Writer {
+    public:
+        void reserve(size_t count);
+        void add(std::string_view id, std::string_view owner, std::string_view username, std::string_view email,
+                 const Money& minimum, const Money& balance, bool admin);
+        // Throws std::runtime_error on I/O errors and std::length_error if
+        // the strings outgrow the format.
+        void write(const std::string& path, uint64_t sequence) const;
+
+    private:
+        struct Text {
+            uint32_t offset;
+            uint16_t lengths[4];
+        };
+
+        std::vector<int64_t> balances;
+        std::vector<int64_t> minimums;
+        std::vector<Text> texts;
+        std::vector<uint8_t> flags;
+        std::string strings;
+    };
+
+    static void write(const std::string& path, const Bank& bank, uint64_t sequence);
+
+private:
+    const unsigned char* base;
+    size_t length;
+    size_t count;
+    uint64_t seq;
+    const int64_t* balances;
+    const int64_t* minimums;
+    const unsigned char* texts;
+    const uint8_t* flags;
+    const uint32_t* byId;
+    const char* strings;
+    size_t stringBytes;
+
+    std::string_view text(size_t row, int field) const;
+};
+
+#endif // ACCOUNT_SNAPSHOT_H
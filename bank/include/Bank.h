@@ -2,33 +2,115 @@
 #ifndef BANK_H
 #define BANK_H
 
+#include <array>
+#include <deque>
 #include <vector>
-#include <memory>
+#include <mutex>
+#include <string_view>
 #include "Account.h"
+#include "AccountIndex.h"
+#include "Ledger.h"
+#include "Storage.h"
+#include "StringPool.h"
+#include "TransactionResult.h"
 
+// Accounts are stored by value in open order, so an account's handle is its
+// position and they sit next to each other in memory; their text is interned
+// in one pool. Pointers returned by the Bank stay valid for its lifetime.
 class Bank {
 public:
-    std::shared_ptr<Account> open(const std::string& owner, const std::string& address,
-                                  const Money& minimumBalance, const Money& initialBalance);
-    std::shared_ptr<Account> findAccount(const std::string& accountId) const;
-    std::string generatePassword(const std::string& owner, const std::string& accountId);
+    Bank();
+    Bank(const Bank&) = delete;
+    Bank& operator=(const Bank&) = delete;
+
+    // Throws std::invalid_argument for a duplicate ID, username or email. If
+    // storage cannot record the open, nothing is opened and its exception
+    // propagates.
+    Account* open(std::string_view owner, std::string_view address,
+                  const Money& minimumBalance, const Money& initialBalance);
+    Account* open(std::string_view owner, std::string_view address,
+                  const Money& minimumBalance, const Money& initialBalance,
+                  std::string_view username, std::string_view email);
+    Account* findAccount(std::string_view accountId) const;
+    Account* findByUsername(std::string_view username) const;
+    Account* findByEmail(std::string_view email) const;
+
+    // Username and email are indexed, and attached storage has to see every
+    // change, so change these through the Bank rather than on the Account.
+    void setUsername(Account& account, std::string_view username);
+    void setEmail(Account& account, std::string_view email);
+    void setPassword(Account& account, const std::string& password);
+    void setIsAdmin(Account& account, bool isAdmin);
+    void reserve(size_t count);
+
+    // Single transfer that reports failures instead of throwing. If storage
+    // cannot record the row the balances are put back and the result is
+    // StorageFailed. Not thread-safe; see transferConcurrent.
+    TransactionResult transfer(const TransactionRequest& request);
+
+    // Thread-safe with respect to other transferConcurrent calls. Each
+    // account maps to one of kLockStripes mutexes and both stripes are locked
+    // in stripe order. Accounts must not be opened while transfers run. The
+    // ledger row is still appended under one bank-wide lock, since row
+    // numbers are global and storage sees rows in order.
+    TransactionResult transferConcurrent(const TransactionRequest& request);
+
+    // Validates the whole batch first, then applies all of it or none of it.
+    // Balances move once per account by the batch's net effect, so only the
+    // net result has to respect each account's minimum balance. Never throws
+    // for a rejected item; the result vector has one entry per request. If
+    // storage cannot record the batch's rows, every result is StorageFailed
+    // and nothing is applied.
+    std::vector<TransactionResult> applyBatch(const TransactionRequest* requests, size_t count);
+    std::vector<TransactionResult> applyBatch(const std::vector<TransactionRequest>& requests);
+
+    // Loads what storage holds into this Bank, which must be empty, then
+    // records every later open and ledger row to it. nullptr detaches.
+    void attachStorage(Storage* storage);
+    // Re-applies a stored ledger row: moves the balances without limit
+    // checks and appends the row with its original timestamp. For
+    // Storage::load; throws std::out_of_range for an unknown handle.
+    void restorePosting(uint32_t source, uint32_t destination, int64_t amountCents, int64_t timestamp,
+                        Transaction::Type type, std::string_view memo);
+    // Re-applies a stored account change. For Storage::load; throws
+    // std::out_of_range for an unknown handle.
+    void restoreUpdate(uint32_t handle, std::string_view username, std::string_view email,
+                       const std::string& password, bool isAdmin);
 
     class Iterator {
     public:
-        explicit Iterator(const std::vector<std::shared_ptr<Account>>& accounts);
+        explicit Iterator(const std::deque<Account>& accounts);
         bool hasNext() const;
-        std::shared_ptr<Account> next();
+        const Account* next();
 
     private:
-        const std::vector<std::shared_ptr<Account>>& accounts;
+        const std::deque<Account>& accounts;
         size_t currentIndex;
     };
 
     Iterator iterator() const;
-    std::vector<std::shared_ptr<Account>> getAccounts() const;
+    std::vector<Account*> getAccounts() const;
+    size_t size() const { return accounts.size(); }
+    const Ledger& getLedger() const;
+
+    static constexpr size_t kLockStripes = 256;
 
 private:
-    std::vector<std::shared_ptr<Account>> accounts;
+    StringPool strings;
+    std::deque<Account> accounts;
+    AccountIndex byId;
+    AccountIndex byUsername;
+    AccountIndex byEmail;
+    Ledger ledger;
+    std::array<std::mutex, kLockStripes> stripes;
+    std::mutex ledgerMutex;
+    Storage* storage;
+
+    Account* at(uint32_t slot) const;
+    uint32_t slotOf(const Account& account) const;
+    TransactionResult resolve(const TransactionRequest& request, uint32_t& source, uint32_t& destination) const;
+    TransactionResult post(uint32_t source, uint32_t destination, const TransactionRequest& request,
+                           std::mutex* ledgerLock);
 };
 
 #endif // BANK_H
@@ -0,0 +1,62 @@
+#ifndef ID_GENERATOR_H
+#define ID_GENERATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Snowflake-style 64-bit ids: 41 bits of milliseconds since kEpochMillis,
+// 10 bits of node and 12 bits of sequence, with the sign bit always clear so
+// an id also fits a signed SQLite INTEGER. Ids from one generator strictly
+// increase, and generators on different nodes never produce the same id.
+//
+// next() is lock-free: the clock reading and the sequence share one atomic
+// word, advanced by a single CAS. When a millisecond's 4096 sequence values
+// run out, or the wall clock steps backwards, the generator keeps counting
+// from its last value instead of waiting, so it briefly runs ahead of the
+// clock rather than ever repeating an id.
+class IdGenerator {
+public:
+    static constexpr int kSequenceBits = 12;
+    static constexpr int kNodeBits = 10;
+    static constexpr int kTimestampBits = 41;
+    static constexpr uint32_t kMaxNode = (1u << kNodeBits) - 1;
+    // 2024-01-01T00:00:00Z; the 41-bit timestamp lasts until 2093.
+    static constexpr int64_t kEpochMillis = 1704067200000;
+    // Width of format(): 13 Crockford base-32 digits cover 65 bits.
+    static constexpr size_t kFormattedLength = 13;
+
+    // Throws std::invalid_argument if node exceeds kMaxNode.
+    explicit IdGenerator(uint32_t node);
+
+    IdGenerator(const IdGenerator&) = delete;
+    IdGenerator& operator=(const IdGenerator&) = delete;
+
+    uint64_t next();
+    uint32_t getNode() const { return node; }
+
+    // A node for this process from the host name and process id. Two
+    // processes can hash to the same node, so this is only a fallback;
+    // processes sharing a database lease distinct nodes from it instead.
+    static uint32_t defaultNode();
+
+    // Fixed-width Crockford base 32, most significant digit first, so the
+    // printed ids sort in the same order as the numbers.
+    static std::string format(uint64_t id);
+    static char* format(uint64_t id, char* first);
+    // Accepts format()'s output, case-insensitively.
+    static std::optional<uint64_t> parse(std::string_view text);
+
+    static int64_t timestampOf(uint64_t id);
+    static uint32_t nodeOf(uint64_t id);
+    static uint32_t sequenceOf(uint64_t id);
+
+private:
+    uint32_t node;
+    // (milliseconds since kEpochMillis << kSequenceBits) | sequence.
+    std::atomic<uint64_t> state;
+};
+
+#endif // ID_GENERATOR_H
@@ -0,0 +1,77 @@
+#ifndef JOURNAL_STORAGE_H
+#define JOURNAL_STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Storage.h"
+
+// Storage as an append-only file of fixed-size, CRC-checked records: account
+// opens and updates, ledger postings, and the memo and string text they
+// refer to. Writes are sequential and buffered; fsync happens every
+// options.syncEvery records. A torn tail (a crash mid-write) is dropped on
+// load, so at most the records since the last sync are lost; damage with
+// intact records after it is reported instead.
+//
+// A failed write or sync is final: buffered records are dropped, whatever
+// the failing call had already written is cut off again, and every later
+// call throws. The file then ends as if the process had crashed there.
+//
+// Records use the host's byte order; the header rejects a journal written
+// with a different order or record size.
+class JournalStorage : public Storage {
+public:
+    struct Options {
+        // fsync after this many records; 0 leaves syncing to sync() and the
+        // destructor. Larger batches trade durability for throughput.
+        size_t syncEvery = 1;
+    };
+
+    // Opens or creates the journal. Throws std::runtime_error on I/O errors.
+    explicit JournalStorage(const std::string& path);
+    JournalStorage(const std::string& path, Options options);
+    ~JournalStorage() override;
+
+    JournalStorage(const JournalStorage&) = delete;
+    JournalStorage& operator=(const JournalStorage&) = delete;
+
+    void recordOpen(const Account& account) override;
+    void recordUpdate(const Account& account) override;
+    void recordPostings(const Ledger& ledger, uint32_t first, uint32_t last) override;
+    void sync() override;
+    // Throws std::runtime_error if the file is not a journal, is damaged
+    // anywhere but its tail, or refers to accounts it never opened.
+    void load(Bank& bank) override;
+
+    static constexpr size_t kRecordSize = 64;
+
+private:
+    std::string path;
+    int fd;
+    Options options;
+    std::vector<unsigned char> pending;
+    // Bytes in the file; the records in pending follow them.
+    uint64_t fileBytes;
+    size_t unsynced;
+    bool failed;
+    std::unordered_map<std::string, uint32_t> memoIds;
+
+    // Where a record call started, so a failure can take it back.
+    struct Mark {
+        uint64_t offset;
+        size_t memos;
+    };
+
+    Mark beginRecord() const;
+    void abandon(const Mark& mark) noexcept;
+    void appendRecord(uint8_t kind, const void* payload, size_t size);
+    void appendText(std::string_view text);
+    uint32_t memoId(std::string_view memo);
+    void recorded(size_t records);
+    void writePending();
+};
+
+#endif // JOURNAL_STORAGE_H
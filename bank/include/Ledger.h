@@ -0,0 +1,129 @@
+#ifndef LEDGER_H
+#define LEDGER_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Money.h"
+#include "RingBuffer.h"
+#include "Storage.h"
+#include "Transaction.h"
+
+class Ledger;
+
+// One posted transaction, read back from the ledger's columns on demand.
+class LedgerEntry {
+public:
+    LedgerEntry(const Ledger* ledger, uint32_t row) : ledger(ledger), row(row) {}
+
+    uint32_t getRow() const { return row; }
+    uint32_t getSource() const;
+    uint32_t getDestination() const;
+    Money getAmount() const;
+    int64_t getTimestamp() const;
+    std::string getDate() const;
+    Transaction::Type getType() const;
+    std::string_view getMemo() const;
+
+private:
+    const Ledger* ledger;
+    uint32_t row;
+};
+
+// An account's posting list: ledger row offsets, oldest first.
+class PostingView {
+public:
+    class Iterator {
+    public:
+        Iterator(const PostingView* view, size_t index) : view(view), index(index) {}
+        LedgerEntry operator*() const { return (*view)[index]; }
+        Iterator& operator++() { ++index; return *this; }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+
+    private:
+        const PostingView* view;
+        size_t index;
+    };
+
+    PostingView() : ledger(nullptr) {}
+    PostingView(const Ledger* ledger, RingBuffer<uint32_t>::View rows) : ledger(ledger), rows(rows) {}
+
+    size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+    LedgerEntry operator[](size_t i) const { return LedgerEntry(ledger, rows[i]); }
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size()); }
+
+private:
+    const Ledger* ledger;
+    RingBuffer<uint32_t>::View rows;
+};
+
+// Append-only, struct-of-arrays store for every posted transaction. Accounts
+// are referred to by their dense Bank handle and memos are dictionary-encoded,
+// so scans and aggregates walk flat integer columns.
+class Ledger {
+public:
+    static constexpr uint32_t kNoAccount = UINT32_MAX;
+
+    Ledger();
+    Ledger(const Ledger&) = delete;
+    Ledger& operator=(const Ledger&) = delete;
+
+    // Timestamps are microseconds since the Unix epoch. They are clamped so
+    // the column never decreases, which keeps time-range scans a binary search.
+    // If the row cannot be stored or storage cannot record it, the ledger is
+    // left as it was and the exception propagates.
+    uint32_t append(uint32_t source, uint32_t destination, int64_t amountCents,
+                    int64_t timestamp, Transaction::Type type, std::string_view memo);
+    // For a batch: appends without telling storage. The caller then records
+    // the batch with recordRows(first) or drops it with truncate(first).
+    uint32_t appendUnrecorded(uint32_t source, uint32_t destination, int64_t amountCents,
+                              int64_t timestamp, Transaction::Type type, std::string_view memo);
+    // Passes rows [first, size()) to storage in one call.
+    void recordRows(uint32_t first) const;
+    // Drops every row from `rows` on. Storage is not told, so only rows it
+    // has not recorded may be dropped.
+    void truncate(size_t rows);
+    void reserve(size_t rows);
+    // Every row append() adds from now on is also passed to storage (nullptr
+    // to stop).
+    void setStorage(Storage* storage);
+
+    size_t size() const { return amounts.size(); }
+    LedgerEntry entry(uint32_t row) const { return LedgerEntry(this, row); }
+
+    const std::vector<uint32_t>& sourceColumn() const { return sources; }
+    const std::vector<uint32_t>& destinationColumn() const { return destinations; }
+    const std::vector<int64_t>& amountColumn() const { return amounts; }
+    const std::vector<int64_t>& timestampColumn() const { return timestamps; }
+    const std::vector<uint8_t>& typeColumn() const { return types; }
+    const std::vector<uint32_t>& memoColumn() const { return memoIds; }
+    std::string_view memoText(uint32_t memoId) const { return memos[memoId]; }
+
+    // Rows with from <= timestamp < to, as a half-open [first, last) range.
+    std::pair<uint32_t, uint32_t> rowsBetween(int64_t from, int64_t to) const;
+    int64_t sumAmounts(uint32_t first, uint32_t last) const;
+    // Money into the account minus money out of it over [first, last).
+    int64_t netFlow(uint32_t account, uint32_t first, uint32_t last) const;
+
+private:
+    std::vector<uint32_t> sources;
+    std::vector<uint32_t> destinations;
+    std::vector<int64_t> amounts;
+    std::vector<int64_t> timestamps;
+    std::vector<uint8_t> types;
+    std::vector<uint32_t> memoIds;
+
+    std::deque<std::string> memos;
+    std::unordered_map<std::string_view, uint32_t> memoLookup;
+    Storage* storage;
+
+    uint32_t internMemo(std::string_view memo);
+};
+
+#endif // LEDGER_H
@@ -0,0 +1,64 @@
+#ifndef LEDGER_WRITER_H
+#define LEDGER_WRITER_H
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
+#include "Bank.h"
+#include "MpscQueue.h"
+#include "TransactionResult.h"
+
+// Single-writer execution mode for a Bank. Any number of threads submit
+// transfers into a bounded lock-free queue; one writer thread owns every
+// Account and applies the commands in queue order without taking locks.
+// While a LedgerWriter is running nothing else may mutate its Bank.
+//
+// Results delivered through the writer outlive the request they came from,
+// so their accountId is only set when it names an existing Account.
+// Bank::transfer reports storage and other failures as results, and an
+// exception from a callback is dropped, so the writer thread keeps running.
+class LedgerWriter {
+public:
+    using Callback = std::function<void(const TransactionResult&)>;
+
+    explicit LedgerWriter(Bank& bank, size_t capacity = 65536);
+    ~LedgerWriter();
+
+    LedgerWriter(const LedgerWriter&) = delete;
+    LedgerWriter& operator=(const LedgerWriter&) = delete;
+
+    // Both block (spinning, then yielding) while the queue is full. All
+    // three throw std::logic_error once stop() has been called, since
+    // nothing would run the command.
+    std::future<TransactionResult> submit(TransactionRequest request);
+    void submit(TransactionRequest request, Callback callback);
+    // Returns false instead of waiting when the queue is full.
+    bool trySubmit(TransactionRequest& request, Callback callback);
+
+    // Applies everything already queued, including submissions racing with
+    // it, then joins the writer thread.
+    void stop();
+
+private:
+    struct Command {
+        TransactionRequest request;
+        std::promise<TransactionResult> promise;
+        Callback callback;
+        bool hasPromise = false;
+    };
+
+    Bank& bank;
+    MpscQueue<Command> queue;
+    std::atomic<bool> running;
+    // Submissions between their running check and their push; the writer
+    // only exits once this is zero and the queue is empty.
+    std::atomic<int> publishing;
+    std::thread writer;
+
+    bool push(Command& command, bool wait);
+    void run();
+    void execute(Command& command);
+};
+
+#endif // LEDGER_WRITER_H
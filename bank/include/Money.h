@@ -1,23 +1,136 @@
 #pragma once
 
-#include <string>
+#include <cmath>
 #include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "MoneyFormat.h"
+
+// Overflow policies for BasicMoney. INT64_MIN is never a valid amount, so
+// every amount can be negated and -INT64_MAX..INT64_MAX is the usable range.
+struct CheckedOverflow {
+    static constexpr int64_t check(int64_t cents) {
+        if (cents == INT64_MIN) throw std::overflow_error("too small");
+        return cents;
+    }
+    static constexpr int64_t add(int64_t a, int64_t b) {
+        int64_t result = 0;
+        if (__builtin_add_overflow(a, b, &result) || result == INT64_MIN) {
+            throw std::overflow_error("overflow or underflow");
+        }
+        return result;
+    }
+    static constexpr int64_t sub(int64_t a, int64_t b) {
+        int64_t result = 0;
+        if (__builtin_sub_overflow(a, b, &result) || result == INT64_MIN) {
+            throw std::overflow_error("overflow or underflow");
+        }
+        return result;
+    }
+};
+
+// Clamps out-of-range results to the nearest representable amount.
+struct SaturatingOverflow {
+    static constexpr int64_t check(int64_t cents) {
+        return cents == INT64_MIN ? -INT64_MAX : cents;
+    }
+    static constexpr int64_t add(int64_t a, int64_t b) {
+        int64_t result = 0;
+        if (__builtin_add_overflow(a, b, &result)) {
+            return b < 0 ? -INT64_MAX : INT64_MAX;
+        }
+        return check(result);
+    }
+    static constexpr int64_t sub(int64_t a, int64_t b) {
+        int64_t result = 0;
+        if (__builtin_sub_overflow(a, b, &result)) {
+            return b > 0 ? -INT64_MAX : INT64_MAX;
+        }
+        return check(result);
+    }
+};
 
-class Money {
+// No range checks at all; the caller guarantees amounts stay in range.
+// Plain arithmetic lets the compiler vectorize bulk balance math.
+struct UncheckedOverflow {
+    static constexpr int64_t check(int64_t cents) { return cents; }
+    static constexpr int64_t add(int64_t a, int64_t b) { return a + b; }
+    static constexpr int64_t sub(int64_t a, int64_t b) { return a - b; }
+};
+
+template <typename OverflowPolicy>
+class BasicMoney {
 private:
+    struct Raw {};
     int64_t cents;
 
+    constexpr BasicMoney(int64_t cents, Raw) : cents(cents) {}
+
 public:
-    Money(int64_t cents);
-    Money(double amt);
-
-    static Money fromCents(int64_t cents);
-    static Money fromDollars(double dollars);
-
-    Money negate() const;
-    Money add(const Money& other) const;
-    Money sub(const Money& other) const;
-    std::string toString() const;
-    int compareTo(const Money& other) const;
-    double getDollars() const;
-};
\ No newline at end of file
+    using Policy = OverflowPolicy;
+
+    constexpr BasicMoney(int64_t cents) : cents(Policy::check(cents)) {}
+    BasicMoney(double amt) : cents(0) {
+        if (amt > 92233720368547758.07 || amt < -92233720368547758.07) {
+            throw std::overflow_error("amount is not in range");
+        }
+        cents = static_cast<int64_t>(std::round(amt * 100));
+    }
+
+    static constexpr BasicMoney fromCents(int64_t cents) { return BasicMoney(cents); }
+    static BasicMoney fromDollars(double dollars) { return BasicMoney(dollars); }
+
+    constexpr int64_t getCents() const { return cents; }
+    constexpr double getDollars() const { return static_cast<double>(cents) / 100.0; }
+
+    constexpr BasicMoney negate() const { return BasicMoney(-cents, Raw{}); }
+    constexpr BasicMoney add(const BasicMoney& other) const {
+        return BasicMoney(Policy::add(cents, other.cents), Raw{});
+    }
+    constexpr BasicMoney sub(const BasicMoney& other) const {
+        return BasicMoney(Policy::sub(cents, other.cents), Raw{});
+    }
+    constexpr int compareTo(const BasicMoney& other) const {
+        return (cents > other.cents) - (cents < other.cents);
+    }
+
+    char* format(char* first, char* last, MoneyStyle style = MoneyStyle::Accounting) const {
+        return formatMoney(first, last, cents, style);
+    }
+    std::string toString() const {
+        char buffer[kMaxMoneyChars];
+        return std::string(buffer, format(buffer, buffer + sizeof(buffer)));
+    }
+
+    constexpr BasicMoney operator-() const { return negate(); }
+    constexpr BasicMoney& operator+=(const BasicMoney& other) { return *this = add(other); }
+    constexpr BasicMoney& operator-=(const BasicMoney& other) { return *this = sub(other); }
+
+    friend constexpr BasicMoney operator+(const BasicMoney& a, const BasicMoney& b) { return a.add(b); }
+    friend constexpr BasicMoney operator-(const BasicMoney& a, const BasicMoney& b) { return a.sub(b); }
+    friend constexpr bool operator==(const BasicMoney& a, const BasicMoney& b) { return a.cents == b.cents; }
+    friend constexpr bool operator!=(const BasicMoney& a, const BasicMoney& b) { return a.cents != b.cents; }
+    friend constexpr bool operator<(const BasicMoney& a, const BasicMoney& b) { return a.cents < b.cents; }
+    friend constexpr bool operator<=(const BasicMoney& a, const BasicMoney& b) { return a.cents <= b.cents; }
+    friend constexpr bool operator>(const BasicMoney& a, const BasicMoney& b) { return a.cents > b.cents; }
+    friend constexpr bool operator>=(const BasicMoney& a, const BasicMoney& b) { return a.cents >= b.cents; }
+};
+
+// Sums a range of amounts in one pass; with UncheckedOverflow this reduces
+// to a plain integer reduction the compiler can vectorize.
+template <typename OverflowPolicy, typename It>
+constexpr BasicMoney<OverflowPolicy> sumAmounts(It first, It last, BasicMoney<OverflowPolicy> init) {
+    int64_t total = init.getCents();
+    for (; first != last; ++first) {
+        total = OverflowPolicy::add(total, first->getCents());
+    }
+    return BasicMoney<OverflowPolicy>::fromCents(total);
+}
+
+// Release builds can opt out of range checks with -DBANK_UNCHECKED_MONEY.
+#ifdef BANK_UNCHECKED_MONEY
+using Money = BasicMoney<UncheckedOverflow>;
+#else
+using Money = BasicMoney<CheckedOverflow>;
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Accounting renders "$12.34" / "($12.34)", matching Money::toString.
+// Plain renders "12.34" / "-12.34" for table cells and exports.
+enum class MoneyStyle { Accounting, Plain };
+
+// Longest possible output: "($92233720368547758.07)".
+constexpr size_t kMaxMoneyChars = 24;
+
+// Writes cents into [first, last) without touching the heap or the locale.
+// Returns one past the last character written, or nullptr if it did not fit.
+inline char* formatMoney(char* first, char* last, int64_t cents, MoneyStyle style = MoneyStyle::Accounting) {
+    const bool negative = cents < 0;
+    const uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(cents) : static_cast<uint64_t>(cents);
+    const bool accounting = style == MoneyStyle::Accounting;
+
+    char buffer[kMaxMoneyChars];
+    char* out = buffer;
+    if (negative) *out++ = accounting ? '(' : '-';
+    if (accounting) *out++ = '$';
+    out = std::to_chars(out, buffer + sizeof(buffer), magnitude / 100).ptr;
+    const unsigned fraction = static_cast<unsigned>(magnitude % 100);
+    *out++ = '.';
+    *out++ = static_cast<char>('0' + fraction / 10);
+    *out++ = static_cast<char>('0' + fraction % 10);
+    if (negative && accounting) *out++ = ')';
+
+    const size_t length = static_cast<size_t>(out - buffer);
+    if (static_cast<size_t>(last - first) < length) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        first[i] = buffer[i];
+    }
+    return first + length;
+}
+
+// Formats a whole column of amounts into one contiguous arena, so a report
+// or export that needs every row costs a couple of allocations however many
+// rows it has. (A lazy view that formats only visible cells is better off
+// calling formatMoney per cell.) Cells stay valid until the next clear() or
+// append().
+class MoneyColumn {
+public:
+    explicit MoneyColumn(MoneyStyle style = MoneyStyle::Plain);
+
+    void clear();
+    void reserve(size_t count);
+    void append(int64_t cents);
+
+    template <typename It>
+    void assign(It first, It last) {
+        clear();
+        for (; first != last; ++first) {
+            append(first->getCents());
+        }
+    }
+
+    size_t size() const { return offsets.size() - 1; }
+    std::string_view operator[](size_t row) const {
+        return std::string_view(arena.data() + offsets[row], offsets[row + 1] - offsets[row]);
+    }
+
+private:
+    MoneyStyle style;
+    std::vector<char> arena;
+    std::vector<uint32_t> offsets;
+};
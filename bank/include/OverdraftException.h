@@ -2,18 +2,24 @@
 #define OVERDRAFT_EXCEPTION_H
 
 #include <stdexcept>
-#include "Account.h"
+#include <string>
+#include <string_view>
 #include "Money.h"
 
+class Account;
+
+// Keeps only the account ID and shortfall, not the Account, so it can
+// outlive the account it reports on.
 class OverdraftException : public std::runtime_error {
 private:
-    Account account;
+    std::string accountId;
     Money amount;
 
 public:
     OverdraftException(const Account& account, const Money& amount);
+    OverdraftException(std::string_view accountId, const Money& amount);
 
-    const Account& getAccount() const;
+    const std::string& getAccountId() const;
     Money getAmount() const;
 };
 
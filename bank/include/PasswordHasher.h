@@ -0,0 +1,53 @@
+#ifndef PASSWORD_HASHER_H
+#define PASSWORD_HASHER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Salted scrypt password hashes in a self-describing text form:
+//
+//     $scrypt$ln=15,r=8,p=1$<salt>$<hash>
+//
+// with the salt and hash in unpadded base64. The cost travels with each
+// hash, so raising Params::interactive() later only affects new hashes, and
+// needsRehash() tells a successful login to upgrade an old one. Stored
+// values that are not in this form are legacy plaintext passwords; they
+// still verify, and always need a rehash. A stored value starting with
+// kDisabled never verifies.
+//
+// All functions are thread-safe and CPU- and memory-bound: run them on a
+// worker pool, not the GUI thread. bench/PasswordHashBenchmark sizes the cost.
+class PasswordHasher {
+public:
+    struct Params {
+        uint32_t log2N;
+        uint32_t r;
+        uint32_t p;
+
+        // 32 MiB per hash, on the order of 100 ms on a desktop core.
+        static constexpr Params interactive() { return {15, 8, 1}; }
+        size_t memoryBytes() const { return size_t(128) * r << log2N; }
+    };
+
+    static constexpr std::string_view kDisabled = "!";
+    static constexpr size_t kSaltSize = 16;
+    static constexpr size_t kHashSize = 32;
+
+    static std::string hash(std::string_view password, Params params = Params::interactive());
+    // Compares in constant time. An unknown user should still be checked,
+    // against an empty stored value, so a miss costs as much as a hit.
+    static bool verify(std::string_view password, std::string_view stored);
+    static bool needsRehash(std::string_view stored, Params params = Params::interactive());
+
+    // A random password from the OS entropy source, in an alphabet without
+    // look-alike characters.
+    static std::string generatePassword(size_t length = 12);
+    // Fills data from the OS entropy source; throws std::runtime_error if
+    // it is unavailable.
+    static void randomBytes(uint8_t* data, size_t size);
+
+    static bool constantTimeEquals(const uint8_t* a, const uint8_t* b, size_t size);
+};
+
+#endif // PASSWORD_HASHER_H
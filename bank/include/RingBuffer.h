@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Fixed-capacity FIFO that overwrites its oldest element once full. Storage
+// is allocated on the first push and never grows past the capacity.
+template <typename T>
+class RingBuffer {
+public:
+    // Non-owning window over up to two contiguous runs of the buffer, oldest
+    // element first. Invalidated by the next push or setCapacity.
+    class View {
+    public:
+        class Iterator {
+        public:
+            Iterator(const View* view, size_t index) : view(view), index(index) {}
+            const T& operator*() const { return (*view)[index]; }
+            const T* operator->() const { return &(*view)[index]; }
+            Iterator& operator++() { ++index; return *this; }
+            bool operator==(const Iterator& other) const { return index == other.index; }
+            bool operator!=(const Iterator& other) const { return index != other.index; }
+
+        private:
+            const View* view;
+            size_t index;
+        };
+
+        View() : head(nullptr), headSize(0), tail(nullptr), tailSize(0) {}
+        View(const T* head, size_t headSize, const T* tail, size_t tailSize)
+            : head(head), headSize(headSize), tail(tail), tailSize(tailSize) {}
+
+        size_t size() const { return headSize + tailSize; }
+        bool empty() const { return size() == 0; }
+        const T& operator[](size_t i) const { return i < headSize ? head[i] : tail[i - headSize]; }
+        Iterator begin() const { return Iterator(this, 0); }
+        Iterator end() const { return Iterator(this, size()); }
+
+    private:
+        const T* head;
+        size_t headSize;
+        const T* tail;
+        size_t tailSize;
+    };
+
+    explicit RingBuffer(size_t capacity) : limit(capacity), start(0) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Ring buffer capacity must be positive");
+        }
+    }
+
+    size_t size() const { return items.size(); }
+    size_t capacity() const { return limit; }
+    bool empty() const { return items.empty(); }
+
+    void push(const T& value) {
+        if (items.size() < limit) {
+            if (items.capacity() == 0) items.reserve(limit);
+            items.push_back(value);
+        } else {
+            items[start] = value;
+            start = (start + 1) % limit;
+        }
+    }
+
+    // Keeps the newest min(size(), capacity) elements.
+    void setCapacity(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Ring buffer capacity must be positive");
+        }
+        std::rotate(items.begin(), items.begin() + start, items.end());
+        start = 0;
+        if (items.size() > capacity) {
+            items.erase(items.begin(), items.end() - capacity);
+        }
+        items.shrink_to_fit();
+        limit = capacity;
+    }
+
+    // The newest min(count, size()) elements, oldest first.
+    View last(size_t count) const {
+        count = std::min(count, items.size());
+        size_t first = (start + items.size() - count) % std::max<size_t>(items.size(), 1);
+        size_t headSize = std::min(count, items.size() - first);
+        return View(items.data() + first, headSize, items.data(), count - headSize);
+    }
+
+private:
+    std::vector<T> items;
+    size_t limit;
+    size_t start;
+};
@@ -0,0 +1,43 @@
+#ifndef SCRYPT_H
+#define SCRYPT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Self-contained SHA-256, PBKDF2-HMAC-SHA256 and scrypt (RFC 7914), so the
+// credential code needs no crypto library. Nothing here is hardware
+// accelerated; scrypt's cost is dominated by its memory traffic anyway.
+class Sha256 {
+public:
+    static constexpr size_t kDigestSize = 32;
+    static constexpr size_t kBlockSize = 64;
+
+    Sha256();
+
+    void update(const uint8_t* data, size_t size);
+    void finish(uint8_t digest[kDigestSize]);
+
+    static void hash(const uint8_t* data, size_t size, uint8_t digest[kDigestSize]);
+
+private:
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t buffer[kBlockSize];
+    size_t buffered;
+
+    void compress(const uint8_t* block);
+};
+
+void pbkdf2Sha256(const uint8_t* password, size_t passwordSize, const uint8_t* salt, size_t saltSize,
+                  uint32_t iterations, uint8_t* out, size_t outSize);
+
+// Largest 128 * r * n scratch allocation scrypt() accepts.
+constexpr uint64_t kScryptMaxScratch = uint64_t(1) << 30;
+
+// n must be a power of two above 1. Needs 128 * r * n bytes of scratch
+// memory per call; throws std::invalid_argument for parameters outside
+// RFC 7914's limits or above kScryptMaxScratch.
+void scrypt(const uint8_t* password, size_t passwordSize, const uint8_t* salt, size_t saltSize,
+            uint64_t n, uint32_t r, uint32_t p, uint8_t* out, size_t outSize);
+
+#endif // SCRYPT_H
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+class Account;
+class Bank;
+class Ledger;
+
+// Durable home for a Bank's state. Once attached (Bank::attachStorage), the
+// Bank reports every account it opens, every change it makes to one, and
+// every ledger row it appends, in order; load() rebuilds a Bank from what
+// was recorded. Calls are never concurrent: transferConcurrent records rows
+// under the ledger lock.
+//
+// A record call that throws has recorded nothing, so the Bank can undo the
+// change it was reporting. Write failures throw std::runtime_error; after
+// one, storage may refuse every later call rather than risk a gap.
+class Storage {
+public:
+    virtual ~Storage() = default;
+
+    virtual void recordOpen(const Account& account) = 0;
+    // The account's username, email, password or admin flag changed.
+    virtual void recordUpdate(const Account& account) = 0;
+    // Ledger rows [first, last), as one unit: all of them or none.
+    virtual void recordPostings(const Ledger& ledger, uint32_t first, uint32_t last) = 0;
+    // Makes everything recorded so far durable.
+    virtual void sync() = 0;
+    // Opens the stored accounts on an empty bank and replays its postings.
+    virtual void load(Bank& bank) = 0;
+};
@@ -0,0 +1,52 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Arena.h"
+
+// Interns short strings such as owner names, usernames and emails. Each
+// distinct string is stored once, in arena blocks that never move, and is
+// named by a 32-bit id, so a record can refer to its text with four bytes
+// and equal strings compare by id. Id 0 is always the empty string.
+//
+// Not thread-safe for intern(); view() may be called concurrently with other
+// view() calls.
+class StringPool {
+public:
+    using Id = uint32_t;
+
+    static constexpr Id kEmpty = 0;
+
+    StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    Id intern(std::string_view text);
+    // kEmpty if text was never interned.
+    Id find(std::string_view text) const;
+    // Valid until clear(); throws std::out_of_range for an unknown id.
+    std::string_view view(Id id) const;
+
+    size_t size() const { return strings.size(); }
+    size_t bytesReserved() const;
+    void reserve(size_t count);
+    // Forgets every string; views and ids handed out earlier become invalid.
+    void clear();
+
+private:
+    Arena text;
+    std::vector<std::string_view> strings;
+    // Open-addressing table of ids into strings; kEmpty marks a free slot,
+    // which is safe because the empty string is never looked up in it.
+    std::vector<Id> table;
+    std::vector<uint32_t> hashes;
+
+    static uint32_t hashOf(std::string_view text);
+    size_t slotOf(std::string_view text, uint32_t hash) const;
+    void rehash(size_t capacity);
+};
+
+#endif // STRING_POOL_H
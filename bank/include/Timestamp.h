@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Display renders "2024-03-09 14:05:07" for history lists and the CLI.
+// Iso8601 renders "2024-03-09T14:05:07", the local-time form Qt::ISODate
+// writes and the transactions table already stores.
+enum class TimestampStyle { Display, Iso8601 };
+
+// Both styles are this long for years 0 through 9999.
+constexpr size_t kTimestampChars = 19;
+// Worst case, for a year outside 0..9999.
+constexpr size_t kMaxTimestampChars = 32;
+
+// Microseconds since the Unix epoch, the unit the Ledger stores.
+int64_t currentTimestamp();
+
+// Writes micros as local time into [first, last) without the locale, a
+// stream or the heap. Returns one past the last character written, or
+// nullptr if it did not fit.
+//
+// Each thread caches the local date it last rendered together with the UTC
+// offset in force that day, so a run of timestamps from the same day costs
+// a few integer divisions each. libc is only consulted, through the
+// reentrant localtime_r, when a timestamp falls outside the cached day.
+// Safe to call from any thread.
+char* formatTimestamp(char* first, char* last, int64_t micros,
+                      TimestampStyle style = TimestampStyle::Display);
+std::string formatTimestamp(int64_t micros, TimestampStyle style = TimestampStyle::Display);
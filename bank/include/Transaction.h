@@ -2,6 +2,7 @@
 
 #include <string>
 #include "Money.h"
+#include "TransactionResult.h"
 #include <chrono>
 
 class Account;
@@ -13,6 +14,12 @@ public:
     Transaction(Account* source, Account* destination, const Money& amount);
     Transaction(const std::string& memo, Account* source, Account* destination, const Money& amount);
 
+    // Applies the transaction or leaves both balances untouched. Never throws:
+    // if the ledger row cannot be recorded, the balances are put back and the
+    // result is StorageFailed (or Failed for any other error).
+    TransactionResult tryPerform(bool force = false);
+    // Throwing form of tryPerform; returns the cash paid out (-amount for a
+    // deposit, amount for a withdrawal, zero for a transfer).
     Money perform(bool force = false);
     std::string toString() const;
 
@@ -20,8 +27,13 @@ public:
     std::string getDate() const;
     Money getAmount() const;
     Type getType() const;
+    const std::string& getMemo() const;
+    // Microseconds since the Unix epoch, as stored in the Ledger.
+    int64_t getTimestamp() const;
 
 private:
+    void record() const;
+
     std::string memo;
     Account* source;
     Account* destination;
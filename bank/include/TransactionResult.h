@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Money.h"
+
+// A transfer between two accounts by ID. An empty source ID makes it a
+// deposit and an empty destination ID makes it a withdrawal.
+struct TransactionRequest {
+    std::string sourceId;
+    std::string destinationId;
+    Money amount = Money::fromCents(0);
+    std::string memo;
+};
+
+enum class TransactionStatus : uint8_t {
+    Ok,
+    UnknownAccount,
+    InvalidAmount,
+    SameAccount,
+    InsufficientFunds,
+    Overflow,
+    NotApplied,      // valid on its own, but another item in its batch failed
+    StorageFailed,   // storage could not record it; nothing was applied
+    Failed,          // an unexpected exception, e.g. out of memory; nothing was applied
+};
+
+// Outcome of a non-throwing operation. accountId names the account that
+// caused the failure and points into either the Account or the request, so
+// it is only valid while those are.
+struct TransactionResult {
+    TransactionStatus status = TransactionStatus::Ok;
+    int64_t shortfallCents = 0;
+    std::string_view accountId;
+
+    bool ok() const { return status == TransactionStatus::Ok; }
+};
@@ -3,48 +3,79 @@
 #include <stdexcept>
 #include <algorithm>
 
-Account::Account(const std::string& owner, const std::string& id, const Money& minimumBalance, const Money& initialBalance)
-    : owner(owner), id(id), minimum(minimumBalance), current(initialBalance), admin(false) {
+Account::Account(StringPool& strings, std::string_view owner, std::string_view id,
+                 const Money& minimumBalance, const Money& initialBalance)
+    : current(initialBalance), minimum(minimumBalance), handle(Ledger::kNoAccount), flags(0),
+      id(StringPool::kEmpty), owner(StringPool::kEmpty), username(StringPool::kEmpty), email(StringPool::kEmpty),
+      strings(&strings), ledger(nullptr), postings(kDefaultHistoryCapacity) {
     if (owner.empty() || id.empty() || id.length() < 4) {
         throw std::invalid_argument("Invalid account parameters");
     }
-    if (initialBalance.compareTo(minimumBalance) < 0) {
+    if (initialBalance < minimumBalance) {
         throw std::invalid_argument("Initial balance cannot be less than minimum balance");
     }
+    this->id = strings.intern(id);
+    this->owner = strings.intern(owner);
 }
 
-std::string Account::getOwner() const { return owner; }
-std::string Account::getID() const { return id; }
+std::string_view Account::getOwner() const { return strings->view(owner); }
+std::string_view Account::getID() const { return strings->view(id); }
 Money Account::getCurrent() const { return current; }
 Money Account::getMinimum() const { return minimum; }
-std::string Account::getEmail() const { return email; }
-std::string Account::getPassword() const { return password; }
-bool Account::isAdmin() const { return admin; }
+std::string_view Account::getEmail() const { return strings->view(email); }
+const std::string& Account::getPassword() const { return password; }
+bool Account::isAdmin() const { return (flags & AdminFlag) != 0; }
 
-void Account::setEmail(const std::string& newEmail) { email = newEmail; }
+void Account::setEmail(std::string_view newEmail) { email = strings->intern(newEmail); }
 void Account::setPassword(const std::string& newPassword) { password = newPassword; }
-void Account::setIsAdmin(bool isAdmin) { admin = isAdmin; }
+void Account::setIsAdmin(bool isAdmin) { flags = isAdmin ? (flags | AdminFlag) : (flags & ~AdminFlag); }
+
+TransactionResult Account::tryAdjust(const Money& amount, bool force) noexcept {
+    TransactionResult result;
+    int64_t balance = 0;
+    if (__builtin_add_overflow(current.getCents(), amount.getCents(), &balance) || balance == INT64_MIN) {
+        result.status = TransactionStatus::Overflow;
+        result.accountId = getID();
+        return result;
+    }
+    if (!force && balance < minimum.getCents() && amount.getCents() < 0) {
+        result.status = TransactionStatus::InsufficientFunds;
+        result.shortfallCents = minimum.getCents() - balance;
+        result.accountId = getID();
+        return result;
+    }
+    current = Money::fromCents(balance);
+    return result;
+}
 
 void Account::adjust(const Money& amount, bool force) {
-    Money newBalance = current.add(amount);
-    if (!force && newBalance.compareTo(minimum) < 0 && amount.compareTo(Money::fromCents(0)) < 0) {
-        throw OverdraftException(*this, minimum.sub(newBalance));
+    TransactionResult result = tryAdjust(amount, force);
+    if (result.status == TransactionStatus::InsufficientFunds) {
+        throw OverdraftException(getID(), Money::fromCents(result.shortfallCents));
+    }
+    if (result.status == TransactionStatus::Overflow) {
+        throw std::overflow_error("overflow or underflow");
     }
-    current = newBalance;
 }
 
-void Account::addTransaction(const Transaction& transaction) {
-    transactions.push_back(transaction);
+void Account::addPosting(uint32_t row) {
+    postings.push(row);
 }
 
-std::vector<Transaction> Account::getLastTransactions(int count) const {
-    std::vector<Transaction> lastTransactions;
-    int size = transactions.size();
-    for (int i = std::max(0, size - count); i < size; ++i) {
-        lastTransactions.push_back(transactions[i]);
-    }
-    return lastTransactions;
+Account::History Account::getLastTransactions(int count) const {
+    return History(ledger, postings.last(static_cast<size_t>(std::max(0, count))));
+}
+
+size_t Account::getHistoryCapacity() const { return postings.capacity(); }
+void Account::setHistoryCapacity(size_t capacity) { postings.setCapacity(capacity); }
+
+std::string_view Account::getUsername() const { return strings->view(username); }
+void Account::setUsername(std::string_view newUsername) { username = strings->intern(newUsername); }
+
+void Account::attachLedger(Ledger* newLedger, uint32_t newHandle) {
+    ledger = newLedger;
+    handle = newHandle;
 }
 
-std::string Account::getUsername() const { return username; }
-void Account::setUsername(const std::string& newUsername) { username = newUsername; }
\ No newline at end of file
+Ledger* Account::getLedger() const { return ledger; }
+uint32_t Account::getHandle() const { return handle; }
\ No newline at end of file
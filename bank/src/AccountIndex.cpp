@@ -0,0 +1,105 @@
+#include "AccountIndex.h"
+#include "Account.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+constexpr size_t kMinCapacity = 16;
+}
+
+AccountIndex::AccountIndex(KeyOf keyOf) : keyOf(keyOf), size(0) {}
+
+uint32_t AccountIndex::hashOf(std::string_view key) {
+    size_t h = std::hash<std::string_view>{}(key);
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+uint32_t AccountIndex::find(std::string_view key, const Accounts& accounts) const {
+    if (entries.empty()) {
+        return npos;
+    }
+    const size_t mask = entries.size() - 1;
+    const uint32_t hash = hashOf(key);
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Entry& entry = entries[i];
+        if (entry.slot == npos) {
+            return npos;
+        }
+        if (entry.hash == hash && (accounts[entry.slot].*keyOf)() == key) {
+            return entry.slot;
+        }
+    }
+}
+
+bool AccountIndex::contains(std::string_view key, const Accounts& accounts) const {
+    return find(key, accounts) != npos;
+}
+
+void AccountIndex::insert(uint32_t slot, const Accounts& accounts) {
+    if ((size + 1) * 2 > entries.size()) {
+        rehash(std::max(kMinCapacity, entries.size() * 2));
+    }
+    place({hashOf((accounts[slot].*keyOf)()), slot});
+    ++size;
+}
+
+void AccountIndex::erase(std::string_view key, const Accounts& accounts) {
+    if (entries.empty()) {
+        return;
+    }
+    const size_t mask = entries.size() - 1;
+    const uint32_t hash = hashOf(key);
+    size_t i = hash & mask;
+    for (;; i = (i + 1) & mask) {
+        const Entry& entry = entries[i];
+        if (entry.slot == npos) {
+            return;
+        }
+        if (entry.hash == hash && (accounts[entry.slot].*keyOf)() == key) {
+            break;
+        }
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones.
+    for (size_t j = (i + 1) & mask;; j = (j + 1) & mask) {
+        if (entries[j].slot == npos) {
+            break;
+        }
+        size_t home = entries[j].hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            entries[i] = entries[j];
+            i = j;
+        }
+    }
+    entries[i] = {0, npos};
+    --size;
+}
+
+void AccountIndex::reserve(size_t count) {
+    size_t capacity = kMinCapacity;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    if (capacity > entries.size()) {
+        rehash(capacity);
+    }
+}
+
+void AccountIndex::place(Entry entry) {
+    const size_t mask = entries.size() - 1;
+    size_t i = entry.hash & mask;
+    while (entries[i].slot != npos) {
+        i = (i + 1) & mask;
+    }
+    entries[i] = entry;
+}
+
+void AccountIndex::rehash(size_t capacity) {
+    std::vector<Entry> old(capacity, Entry{0, npos});
+    old.swap(entries);
+    for (const Entry& entry : old) {
+        if (entry.slot != npos) {
+            place(entry);
+        }
+    }
+}
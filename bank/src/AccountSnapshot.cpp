@@ -0,0 +1,319 @@
+#include "AccountSnapshot.h"
+#include "Account.h"
+#include "Bank.h"
+#include "Crc32.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'F', 'S', 'N', 'A', 'P', 'S', 'H'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kHeaderSize = 64;
+constexpr size_t kTextSize = 12;  // uint32 offset + four uint16 lengths
+constexpr size_t kMinRowBytes = 8 + 8 + kTextSize + 1 + 4;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint64_t sequence;
+    uint64_t count;
+    uint64_t stringBytes;
+    uint32_t bodyCrc;
+    uint32_t headerCrc;  // of the bytes before it
+};
+
+static_assert(sizeof(Header) <= kHeaderSize, "header fits its slot");
+
+// Byte offsets of each column. Every column starts 8-byte aligned.
+struct Layout {
+    size_t balances;
+    size_t minimums;
+    size_t texts;
+    size_t flags;
+    size_t byId;
+    size_t strings;
+    size_t end;
+};
+
+size_t align8(size_t n) {
+    return (n + 7) & ~size_t(7);
+}
+
+Layout layoutFor(size_t count, size_t stringBytes) {
+    Layout layout;
+    layout.balances = kHeaderSize;
+    layout.minimums = layout.balances + 8 * count;
+    layout.texts = layout.minimums + 8 * count;
+    layout.flags = align8(layout.texts + kTextSize * count);
+    layout.byId = align8(layout.flags + count);
+    layout.strings = align8(layout.byId + 4 * count);
+    layout.end = layout.strings + stringBytes;
+    return layout;
+}
+
+uint32_t headerCrc(const Header& header) {
+    return crc32(&header, offsetof(Header, headerCrc));
+}
+
+enum : uint8_t { kAdminFlag = 1 };
+
+[[noreturn]] void throwErrno(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+// Sequential writer that checksums everything after the header.
+class SectionWriter {
+public:
+    SectionWriter(int fd, const std::string& path) : fd(fd), path(path), offset(kHeaderSize), crc(0) {}
+
+    void put(const void* data, size_t size) {
+        crc = crc32(data, size, crc);
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+        if (buffer.size() >= kBufferBytes) flush();
+    }
+
+    void padTo(size_t position) {
+        static const unsigned char zeros[8] = {};
+        size_t at = offset + buffer.size();
+        if (position > at) put(zeros, position - at);
+    }
+
+    void flush() {
+        size_t written = 0;
+        while (written < buffer.size()) {
+            ssize_t n = ::pwrite(fd, buffer.data() + written, buffer.size() - written,
+                                 static_cast<off_t>(offset + written));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) throwErrno("Cannot write snapshot", path);
+            written += static_cast<size_t>(n);
+        }
+        offset += buffer.size();
+        buffer.clear();
+    }
+
+    uint32_t checksum() const { return crc; }
+
+private:
+    static constexpr size_t kBufferBytes = 1 << 20;
+    int fd;
+    const std::string& path;
+    size_t offset;
+    uint32_t crc;
+    std::vector<unsigned char> buffer;
+};
+
+} // namespace
+
+AccountSnapshot::AccountSnapshot(const std::string& path) : base(nullptr), length(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throwErrno("Cannot open snapshot", path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throwErrno("Cannot stat snapshot", path);
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length < kHeaderSize) {
+        ::close(fd);
+        throw std::runtime_error("Not a snapshot: " + path);
+    }
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throwErrno("Cannot map snapshot", path);
+    }
+    base = static_cast<const unsigned char*>(mapping);
+
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion
+              && header.byteOrderMark == kByteOrderMark && header.headerCrc == headerCrc(header)
+              && header.count <= length / kMinRowBytes && header.stringBytes <= length;
+    Layout layout = valid ? layoutFor(header.count, header.stringBytes) : Layout{};
+    if (!valid || layout.end != length) {
+        ::munmap(mapping, length);
+        throw std::runtime_error("Not a snapshot or truncated: " + path);
+    }
+
+    count = header.count;
+    seq = header.sequence;
+    stringBytes = header.stringBytes;
+    balances = reinterpret_cast<const int64_t*>(base + layout.balances);
+    minimums = reinterpret_cast<const int64_t*>(base + layout.minimums);
+    texts = base + layout.texts;
+    flags = base + layout.flags;
+    byId = reinterpret_cast<const uint32_t*>(base + layout.byId);
+    strings = reinterpret_cast<const char*>(base + layout.strings);
+}
+
+AccountSnapshot::~AccountSnapshot() {
+    ::munmap(const_cast<unsigned char*>(base), length);
+}
+
+uint64_t AccountSnapshot::sequence() const { return seq; }
+size_t AccountSnapshot::size() const { return count; }
+
+// Bounds-checked, so a damaged body yields empty strings rather than reads
+// outside the mapping.
+std::string_view AccountSnapshot::text(size_t row, int field) const {
+    uint32_t offset;
+    uint16_t lengths[4];
+    std::memcpy(&offset, texts + row * kTextSize, sizeof(offset));
+    std::memcpy(lengths, texts + row * kTextSize + sizeof(offset), sizeof(lengths));
+    size_t start = offset;
+    for (int i = 0; i < field; ++i) {
+        start += lengths[i];
+    }
+    if (start + lengths[field] > stringBytes) {
+        return {};
+    }
+    return std::string_view(strings + start, lengths[field]);
+}
+
+std::string_view AccountSnapshot::owner(size_t row) const { return text(row, 0); }
+std::string_view AccountSnapshot::id(size_t row) const { return text(row, 1); }
+std::string_view AccountSnapshot::username(size_t row) const { return text(row, 2); }
+std::string_view AccountSnapshot::email(size_t row) const { return text(row, 3); }
+Money AccountSnapshot::balance(size_t row) const { return Money::fromCents(balances[row]); }
+Money AccountSnapshot::minimum(size_t row) const { return Money::fromCents(minimums[row]); }
+bool AccountSnapshot::isAdmin(size_t row) const { return (flags[row] & kAdminFlag) != 0; }
+
+size_t AccountSnapshot::find(std::string_view accountId) const {
+    const uint32_t* first = byId;
+    const uint32_t* last = byId + count;
+    const uint32_t* it = std::lower_bound(first, last, accountId, [this](uint32_t row, std::string_view key) {
+        return row < count && id(row) < key;
+    });
+    if (it == last || *it >= count || id(*it) != accountId) {
+        return npos;
+    }
+    return *it;
+}
+
+bool AccountSnapshot::verify() const {
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    return crc32(base + kHeaderSize, length - kHeaderSize) == header.bodyCrc;
+}
+
+std::unique_ptr<Account> AccountSnapshot::materialize(size_t row, StringPool& strings) const {
+    auto account = std::make_unique<Account>(strings, owner(row), id(row), minimum(row), balance(row));
+    account->setUsername(username(row));
+    account->setEmail(email(row));
+    account->setIsAdmin(isAdmin(row));
+    return account;
+}
+
+void AccountSnapshot::Writer::reserve(size_t count) {
+    balances.reserve(count);
+    minimums.reserve(count);
+    texts.reserve(count);
+    flags.reserve(count);
+}
+
+void AccountSnapshot::Writer::add(std::string_view id, std::string_view owner, std::string_view username,
+                                  std::string_view email, const Money& minimum, const Money& balance, bool admin) {
+    const std::string_view fields[4] = {owner, id, username, email};
+    Text text{static_cast<uint32_t>(strings.size()), {}};
+    size_t total = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (fields[i].size() > UINT16_MAX) {
+            throw std::length_error("Account field too long for a snapshot");
+        }
+        text.lengths[i] = static_cast<uint16_t>(fields[i].size());
+        total += fields[i].size();
+    }
+    if (strings.size() + total > UINT32_MAX) {
+        throw std::length_error("Snapshot string table is full");
+    }
+    for (std::string_view field : fields) {
+        strings.append(field.data(), field.size());
+    }
+    balances.push_back(balance.getCents());
+    minimums.push_back(minimum.getCents());
+    texts.push_back(text);
+    flags.push_back(admin ? kAdminFlag : 0);
+}
+
+void AccountSnapshot::Writer::write(const std::string& path, uint64_t sequence) const {
+    const size_t count = balances.size();
+    auto idOf = [this](uint32_t row) {
+        const Text& text = texts[row];
+        return std::string_view(strings).substr(text.offset + text.lengths[0], text.lengths[1]);
+    };
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&idOf](uint32_t a, uint32_t b) { return idOf(a) < idOf(b); });
+
+    const std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throwErrno("Cannot create snapshot", temporary);
+    }
+    try {
+        const Layout layout = layoutFor(count, strings.size());
+        SectionWriter out(fd, temporary);
+        out.put(balances.data(), 8 * count);
+        out.put(minimums.data(), 8 * count);
+        for (const Text& text : texts) {
+            out.put(&text.offset, sizeof(text.offset));
+            out.put(text.lengths, sizeof(text.lengths));
+        }
+        out.padTo(layout.flags);
+        out.put(flags.data(), count);
+        out.padTo(layout.byId);
+        out.put(order.data(), 4 * count);
+        out.padTo(layout.strings);
+        out.put(strings.data(), strings.size());
+        out.flush();
+
+        unsigned char headerBytes[kHeaderSize] = {};
+        Header header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.byteOrderMark = kByteOrderMark;
+        header.sequence = sequence;
+        header.count = count;
+        header.stringBytes = strings.size();
+        header.bodyCrc = out.checksum();
+        header.headerCrc = headerCrc(header);
+        std::memcpy(headerBytes, &header, sizeof(header));
+        if (::pwrite(fd, headerBytes, kHeaderSize, 0) != static_cast<ssize_t>(kHeaderSize) || ::fsync(fd) != 0) {
+            throwErrno("Cannot write snapshot", temporary);
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temporary.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (::rename(temporary.c_str(), path.c_str()) != 0) {
+        ::unlink(temporary.c_str());
+        throwErrno("Cannot replace snapshot", path);
+    }
+}
+
+void AccountSnapshot::write(const std::string& path, const Bank& bank, uint64_t sequence) {
+    Writer writer;
+    Bank::Iterator it = bank.iterator();
+    while (it.hasNext()) {
+        const Account* account = it.next();
+        writer.add(account->getID(), account->getOwner(), account->getUsername(), account->getEmail(),
+                   account->getMinimum(), account->getCurrent(), account->isAdmin());
+    }
+    writer.write(path, sequence);
+}
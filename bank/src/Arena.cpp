@@ -0,0 +1,77 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+Arena::Arena(size_t blockSize)
+    : blockSize(blockSize), current(0), offset(0), usedBefore(0), finalizers(nullptr) {
+    if (blockSize == 0) {
+        throw std::invalid_argument("Arena block size must be positive");
+    }
+}
+
+Arena::~Arena() {
+    reset();
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    while (current < blocks.size()) {
+        Block& block = blocks[current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+        if (aligned + size <= block.size) {
+            offset = aligned + size;
+            return block.data.get() + aligned;
+        }
+        // Later blocks are only reached after a reset; skip any that are too
+        // small for this request rather than failing it.
+        usedBefore += offset;
+        ++current;
+        offset = 0;
+    }
+
+    size_t capacity = std::max(blockSize, size + alignment);
+    blocks.push_back(Block{std::make_unique<std::byte[]>(capacity), capacity});
+    current = blocks.size() - 1;
+    offset = 0;
+    return allocate(size, alignment);
+}
+
+std::string_view Arena::copy(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+    char* storage = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(storage, text.data(), text.size());
+    return std::string_view(storage, text.size());
+}
+
+void Arena::reset() {
+    while (finalizers) {
+        Finalizer* finalizer = finalizers;
+        finalizers = finalizer->next;
+        finalizer->destroy(finalizer->object);
+    }
+    current = 0;
+    offset = 0;
+    usedBefore = 0;
+}
+
+void Arena::release() {
+    reset();
+    blocks.clear();
+    blocks.shrink_to_fit();
+}
+
+size_t Arena::bytesUsed() const {
+    return usedBefore + offset;
+}
+
+size_t Arena::bytesReserved() const {
+    size_t total = 0;
+    for (const Block& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
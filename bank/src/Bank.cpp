@@ -1,68 +1,418 @@
 #include "Bank.h"
-#include <random>
-#include <sstream>
-#include <iomanip>
-
-std::shared_ptr<Account> Bank::open(const std::string& owner, const std::string& address,
-                                    const Money& minimumBalance, const Money& initialBalance) {
-    auto account = std::make_shared<Account>(owner, address, minimumBalance, initialBalance);
-    accounts.push_back(account);
-    return account;
-}
-
-std::shared_ptr<Account> Bank::findAccount(const std::string& accountId) const {
-    auto it = std::find_if(accounts.begin(), accounts.end(),
-                           [&accountId](const std::shared_ptr<Account>& account) {
-                               return account->getID() == accountId;
-                           });
-    if (it != accounts.end()) {
-        return *it;
-    }
-    return nullptr;
-}
-
-std::string Bank::generatePassword(const std::string& owner, const std::string& accountId) {
-    std::stringstream ss;
-    ss << owner << accountId;
-
-    std::string base = ss.str();
-    
-    // Generate a random number for additional complexity
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(1000, 9999);
-    int randomNumber = dis(gen);
-    
-    ss << randomNumber;
-
-    // Simple hash-like conversion to ensure uniqueness
-    std::hash<std::string> hash_fn;
-    size_t hash = hash_fn(ss.str());
-    
-    std::stringstream passwordStream;
-    passwordStream << std::hex << std::setw(8) << std::setfill('0') << hash;
-    
-    return passwordStream.str();
+#include "Timestamp.h"
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
+
+Bank::Bank()
+    : byId(&Account::getID), byUsername(&Account::getUsername), byEmail(&Account::getEmail), storage(nullptr) {}
+
+Account* Bank::open(std::string_view owner, std::string_view address,
+                    const Money& minimumBalance, const Money& initialBalance) {
+    return open(owner, address, minimumBalance, initialBalance, "", "");
+}
+
+Account* Bank::open(std::string_view owner, std::string_view address,
+                    const Money& minimumBalance, const Money& initialBalance,
+                    std::string_view username, std::string_view email) {
+    if (byId.contains(address, accounts)) {
+        throw std::invalid_argument("Duplicate account ID: " + std::string(address));
+    }
+    if (!username.empty() && byUsername.contains(username, accounts)) {
+        throw std::invalid_argument("Duplicate username: " + std::string(username));
+    }
+    if (!email.empty() && byEmail.contains(email, accounts)) {
+        throw std::invalid_argument("Duplicate email: " + std::string(email));
+    }
+    if (accounts.size() >= AccountIndex::npos) {
+        throw std::length_error("Too many accounts");
+    }
+
+    Account& account = accounts.emplace_back(strings, owner, address, minimumBalance, initialBalance);
+    uint32_t slot = static_cast<uint32_t>(accounts.size() - 1);
+    try {
+        account.setUsername(username);
+        account.setEmail(email);
+        account.attachLedger(&ledger, slot);
+        byId.insert(slot, accounts);
+        if (!username.empty()) byUsername.insert(slot, accounts);
+        if (!email.empty()) byEmail.insert(slot, accounts);
+        if (storage != nullptr) storage->recordOpen(account);
+    } catch (...) {
+        // Storage recorded nothing, so the account was never opened. The
+        // keys are unique, so erasing them only removes this account.
+        byId.erase(address, accounts);
+        if (!username.empty()) byUsername.erase(username, accounts);
+        if (!email.empty()) byEmail.erase(email, accounts);
+        accounts.pop_back();
+        throw;
+    }
+    return &account;
+}
+
+Account* Bank::at(uint32_t slot) const {
+    return slot == AccountIndex::npos ? nullptr : const_cast<Account*>(&accounts[slot]);
+}
+
+Account* Bank::findAccount(std::string_view accountId) const {
+    return at(byId.find(accountId, accounts));
+}
+
+Account* Bank::findByUsername(std::string_view username) const {
+    return username.empty() ? nullptr : at(byUsername.find(username, accounts));
+}
+
+Account* Bank::findByEmail(std::string_view email) const {
+    return email.empty() ? nullptr : at(byEmail.find(email, accounts));
+}
+
+uint32_t Bank::slotOf(const Account& account) const {
+    uint32_t slot = byId.find(account.getID(), accounts);
+    if (slot == AccountIndex::npos || &accounts[slot] != &account) {
+        throw std::invalid_argument("Account does not belong to this bank");
+    }
+    return slot;
+}
+
+void Bank::setUsername(Account& account, std::string_view username) {
+    uint32_t slot = slotOf(account);
+    if (username == account.getUsername()) {
+        return;
+    }
+    if (!username.empty() && byUsername.contains(username, accounts)) {
+        throw std::invalid_argument("Duplicate username: " + std::string(username));
+    }
+    if (!account.getUsername().empty()) byUsername.erase(account.getUsername(), accounts);
+    account.setUsername(username);
+    if (!username.empty()) byUsername.insert(slot, accounts);
+    if (storage != nullptr) storage->recordUpdate(account);
+}
+
+void Bank::setEmail(Account& account, std::string_view email) {
+    uint32_t slot = slotOf(account);
+    if (email == account.getEmail()) {
+        return;
+    }
+    if (!email.empty() && byEmail.contains(email, accounts)) {
+        throw std::invalid_argument("Duplicate email: " + std::string(email));
+    }
+    if (!account.getEmail().empty()) byEmail.erase(account.getEmail(), accounts);
+    account.setEmail(email);
+    if (!email.empty()) byEmail.insert(slot, accounts);
+    if (storage != nullptr) storage->recordUpdate(account);
+}
+
+void Bank::setPassword(Account& account, const std::string& password) {
+    slotOf(account);
+    account.setPassword(password);
+    if (storage != nullptr) storage->recordUpdate(account);
+}
+
+void Bank::setIsAdmin(Account& account, bool isAdmin) {
+    slotOf(account);
+    account.setIsAdmin(isAdmin);
+    if (storage != nullptr) storage->recordUpdate(account);
+}
+
+void Bank::reserve(size_t count) {
+    strings.reserve(count * 3);
+    byId.reserve(count);
+    byUsername.reserve(count);
+    byEmail.reserve(count);
+}
+
+TransactionResult Bank::resolve(const TransactionRequest& request, uint32_t& source, uint32_t& destination) const {
+    TransactionResult result;
+    source = Ledger::kNoAccount;
+    destination = Ledger::kNoAccount;
+    if (request.amount <= Money::fromCents(0)) {
+        result.status = TransactionStatus::InvalidAmount;
+    } else if (request.sourceId.empty() && request.destinationId.empty()) {
+        result.status = TransactionStatus::UnknownAccount;
+    } else if (request.sourceId == request.destinationId) {
+        result.status = TransactionStatus::SameAccount;
+        result.accountId = request.sourceId;
+    } else if (!request.sourceId.empty()
+               && (source = byId.find(request.sourceId, accounts)) == AccountIndex::npos) {
+        result.status = TransactionStatus::UnknownAccount;
+        result.accountId = request.sourceId;
+    } else if (!request.destinationId.empty()
+               && (destination = byId.find(request.destinationId, accounts)) == AccountIndex::npos) {
+        result.status = TransactionStatus::UnknownAccount;
+        result.accountId = request.destinationId;
+    }
+    return result;
+}
+
+TransactionResult Bank::post(uint32_t source, uint32_t destination, const TransactionRequest& request,
+                             std::mutex* ledgerLock) {
+    TransactionResult result;
+    const int64_t amount = request.amount.getCents();
+    Account* from = source != Ledger::kNoAccount ? &accounts[source] : nullptr;
+    Account* to = destination != Ledger::kNoAccount ? &accounts[destination] : nullptr;
+
+    if (from != nullptr && !(result = from->tryAdjust(-request.amount)).ok()) {
+        return result;
+    }
+    if (to != nullptr && !(result = to->tryAdjust(request.amount)).ok()) {
+        if (from != nullptr) from->tryAdjust(request.amount, true);
+        return result;
+    }
+
+    Transaction::Type type = from == nullptr ? Transaction::Type::DEPOSIT
+                           : to == nullptr ? Transaction::Type::WITHDRAWAL
+                           : Transaction::Type::TRANSFER;
+    int64_t now = currentTimestamp();
+    // The ledger and storage are left unchanged on failure; undo the balances too.
+    auto fail = [&](TransactionStatus status) {
+        if (to != nullptr) to->tryAdjust(-request.amount, true);
+        if (from != nullptr) from->tryAdjust(request.amount, true);
+        result.status = status;
+        return result;
+    };
+    uint32_t row;
+    try {
+        if (ledgerLock != nullptr) {
+            std::lock_guard<std::mutex> guard(*ledgerLock);
+            row = ledger.append(source, destination, amount, now, type, request.memo);
+        } else {
+            row = ledger.append(source, destination, amount, now, type, request.memo);
+        }
+    } catch (const std::runtime_error&) {
+        return fail(TransactionStatus::StorageFailed);
+    } catch (const std::exception&) {
+        return fail(TransactionStatus::Failed);
+    }
+    if (from != nullptr) from->addPosting(row);
+    if (to != nullptr) to->addPosting(row);
+    return result;
+}
+
+TransactionResult Bank::transfer(const TransactionRequest& request) {
+    uint32_t source;
+    uint32_t destination;
+    TransactionResult result = resolve(request, source, destination);
+    return result.ok() ? post(source, destination, request, nullptr) : result;
+}
+
+TransactionResult Bank::transferConcurrent(const TransactionRequest& request) {
+    uint32_t source;
+    uint32_t destination;
+    TransactionResult result = resolve(request, source, destination);
+    if (!result.ok()) {
+        return result;
+    }
+
+    // Stripe order is a total order over the locks, so two transfers can
+    // never wait on each other in a cycle.
+    size_t first = source != Ledger::kNoAccount ? source % kLockStripes : kLockStripes;
+    size_t second = destination != Ledger::kNoAccount ? destination % kLockStripes : kLockStripes;
+    if (first > second) std::swap(first, second);
+
+    std::unique_lock<std::mutex> firstLock;
+    std::unique_lock<std::mutex> secondLock;
+    if (first < kLockStripes) firstLock = std::unique_lock<std::mutex>(stripes[first]);
+    if (second < kLockStripes && second != first) secondLock = std::unique_lock<std::mutex>(stripes[second]);
+    return post(source, destination, request, &ledgerMutex);
+}
+
+std::vector<TransactionResult> Bank::applyBatch(const TransactionRequest* requests, size_t count) {
+    struct Resolved {
+        uint32_t source;
+        uint32_t destination;
+    };
+    struct Delta {
+        uint32_t slot;
+        int64_t cents;
+    };
+    struct Shortfall {
+        uint32_t slot;
+        int64_t cents;
+        bool overflow;
+    };
+
+    std::vector<TransactionResult> results(count);
+    std::vector<Resolved> resolved(count, Resolved{Ledger::kNoAccount, Ledger::kNoAccount});
+    std::vector<Delta> deltas;
+    deltas.reserve(count * 2);
+    bool failed = false;
+
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = resolve(requests[i], resolved[i].source, resolved[i].destination);
+        if (!results[i].ok()) {
+            failed = true;
+            continue;
+        }
+        if (resolved[i].source != Ledger::kNoAccount) deltas.push_back({resolved[i].source, -requests[i].amount.getCents()});
+        if (resolved[i].destination != Ledger::kNoAccount) deltas.push_back({resolved[i].destination, requests[i].amount.getCents()});
+    }
+
+    // Group the postings by account and net them, then check each account once.
+    std::sort(deltas.begin(), deltas.end(), [](const Delta& a, const Delta& b) { return a.slot < b.slot; });
+    std::vector<Delta> net;
+    std::vector<Shortfall> shortfalls;
+    for (size_t i = 0; i < deltas.size();) {
+        uint32_t slot = deltas[i].slot;
+        int64_t total = 0;
+        bool overflow = false;
+        for (; i < deltas.size() && deltas[i].slot == slot; ++i) {
+            overflow |= __builtin_add_overflow(total, deltas[i].cents, &total);
+        }
+
+        const Account& account = accounts[slot];
+        int64_t balance = 0;
+        overflow |= __builtin_add_overflow(account.getCurrent().getCents(), total, &balance);
+        if (overflow || total == INT64_MIN || balance == INT64_MIN) {
+            shortfalls.push_back({slot, 0, true});
+        } else if (total < 0 && balance < account.getMinimum().getCents()) {
+            shortfalls.push_back({slot, account.getMinimum().getCents() - balance, false});
+        } else {
+            net.push_back({slot, total});
+        }
+    }
+
+    // Blame each failing account on the items that debit it (or, for an
+    // overflow, on every item that touches it).
+    if (!shortfalls.empty()) {
+        failed = true;
+        auto findShortfall = [&shortfalls](uint32_t slot) -> const Shortfall* {
+            auto it = std::lower_bound(shortfalls.begin(), shortfalls.end(), slot,
+                                       [](const Shortfall& s, uint32_t value) { return s.slot < value; });
+            return it != shortfalls.end() && it->slot == slot ? &*it : nullptr;
+        };
+        for (size_t i = 0; i < count; ++i) {
+            if (!results[i].ok()) {
+                continue;
+            }
+            const Shortfall* shortfall = findShortfall(resolved[i].source);
+            const Shortfall* destination = findShortfall(resolved[i].destination);
+            if (shortfall == nullptr && destination != nullptr && destination->overflow) {
+                shortfall = destination;
+            }
+            if (shortfall != nullptr) {
+                results[i].status = shortfall->overflow ? TransactionStatus::Overflow : TransactionStatus::InsufficientFunds;
+                results[i].shortfallCents = shortfall->cents;
+                results[i].accountId = accounts[shortfall->slot].getID();
+            }
+        }
+    }
+
+    if (failed) {
+        for (TransactionResult& result : results) {
+            if (result.ok()) result.status = TransactionStatus::NotApplied;
+        }
+        return results;
+    }
+
+    // Everything validated: one ledger row per request, recorded to storage
+    // as one unit, and only then one balance update per account. If the
+    // rows cannot be stored or recorded, nothing has moved yet.
+    int64_t now = currentTimestamp();
+    const uint32_t first = static_cast<uint32_t>(ledger.size());
+    TransactionStatus failure = TransactionStatus::Ok;
+    try {
+        ledger.reserve(ledger.size() + count);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t source = resolved[i].source;
+            uint32_t destination = resolved[i].destination;
+            Transaction::Type type = source == Ledger::kNoAccount ? Transaction::Type::DEPOSIT
+                                   : destination == Ledger::kNoAccount ? Transaction::Type::WITHDRAWAL
+                                   : Transaction::Type::TRANSFER;
+            ledger.appendUnrecorded(source, destination, requests[i].amount.getCents(), now, type, requests[i].memo);
+        }
+        ledger.recordRows(first);
+    } catch (const std::runtime_error&) {
+        failure = TransactionStatus::StorageFailed;
+    } catch (const std::exception&) {
+        failure = TransactionStatus::Failed;
+    }
+    if (failure != TransactionStatus::Ok) {
+        ledger.truncate(first);
+        for (TransactionResult& result : results) {
+            result.status = failure;
+        }
+        return results;
+    }
+
+    for (const Delta& delta : net) {
+        accounts[delta.slot].adjust(Money::fromCents(delta.cents), true);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t row = first + static_cast<uint32_t>(i);
+        if (resolved[i].source != Ledger::kNoAccount) accounts[resolved[i].source].addPosting(row);
+        if (resolved[i].destination != Ledger::kNoAccount) accounts[resolved[i].destination].addPosting(row);
+    }
+    return results;
+}
+
+std::vector<TransactionResult> Bank::applyBatch(const std::vector<TransactionRequest>& requests) {
+    return applyBatch(requests.data(), requests.size());
+}
+
+void Bank::attachStorage(Storage* storage) {
+    if (storage != nullptr) {
+        if (!accounts.empty() || ledger.size() != 0) {
+            throw std::logic_error("Storage can only be attached to an empty Bank");
+        }
+        storage->load(*this);
+    }
+    this->storage = storage;
+    ledger.setStorage(storage);
+}
+
+void Bank::restorePosting(uint32_t source, uint32_t destination, int64_t amountCents, int64_t timestamp,
+                          Transaction::Type type, std::string_view memo) {
+    if ((source != Ledger::kNoAccount && source >= accounts.size())
+        || (destination != Ledger::kNoAccount && destination >= accounts.size())) {
+        throw std::out_of_range("Stored posting refers to an unknown account");
+    }
+    Money amount = Money::fromCents(amountCents);
+    if (source != Ledger::kNoAccount) accounts[source].adjust(-amount, true);
+    if (destination != Ledger::kNoAccount) accounts[destination].adjust(amount, true);
+    uint32_t row = ledger.append(source, destination, amountCents, timestamp, type, memo);
+    if (source != Ledger::kNoAccount) accounts[source].addPosting(row);
+    if (destination != Ledger::kNoAccount) accounts[destination].addPosting(row);
+}
+
+void Bank::restoreUpdate(uint32_t handle, std::string_view username, std::string_view email,
+                         const std::string& password, bool isAdmin) {
+    if (handle >= accounts.size()) {
+        throw std::out_of_range("Stored update refers to an unknown account");
+    }
+    Account& account = accounts[handle];
+    setUsername(account, username);
+    setEmail(account, email);
+    account.setPassword(password);
+    account.setIsAdmin(isAdmin);
 }
 
 Bank::Iterator Bank::iterator() const {
     return Iterator(accounts);
 }
 
-Bank::Iterator::Iterator(const std::vector<std::shared_ptr<Account>>& accounts)
+Bank::Iterator::Iterator(const std::deque<Account>& accounts)
     : accounts(accounts), currentIndex(0) {}
 
 bool Bank::Iterator::hasNext() const {
     return currentIndex < accounts.size();
 }
 
-std::shared_ptr<Account> Bank::Iterator::next() {
+const Account* Bank::Iterator::next() {
     if (!hasNext()) {
         throw std::out_of_range("No more accounts");
     }
-    return accounts[currentIndex++];
+    return &accounts[currentIndex++];
+}
+
+std::vector<Account*> Bank::getAccounts() const {
+    std::vector<Account*> result;
+    result.reserve(accounts.size());
+    for (const Account& account : accounts) {
+        result.push_back(const_cast<Account*>(&account));
+    }
+    return result;
 }
 
-std::vector<std::shared_ptr<Account>> Bank::getAccounts() const {
-    return accounts;
+const Ledger& Bank::getLedger() const {
+    return ledger;
 }
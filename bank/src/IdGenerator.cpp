@@ -0,0 +1,104 @@
+#include "IdGenerator.h"
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kDigits[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+constexpr uint64_t kSequenceMask = (uint64_t(1) << IdGenerator::kSequenceBits) - 1;
+constexpr uint64_t kStateLimit = uint64_t(1) << (IdGenerator::kTimestampBits + IdGenerator::kSequenceBits);
+
+uint64_t clockState() {
+    int64_t millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return millis > IdGenerator::kEpochMillis
+        ? static_cast<uint64_t>(millis - IdGenerator::kEpochMillis) << IdGenerator::kSequenceBits
+        : 0;
+}
+
+int digitValue(char c) {
+    if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    for (int value = 0; value < 32; ++value) {
+        if (kDigits[value] == c) return value;
+    }
+    return -1;
+}
+
+} // namespace
+
+IdGenerator::IdGenerator(uint32_t node) : node(node), state(0) {
+    if (node > kMaxNode) {
+        throw std::invalid_argument("Id generator node out of range");
+    }
+}
+
+uint64_t IdGenerator::next() {
+    uint64_t last = state.load(std::memory_order_relaxed);
+    uint64_t claimed;
+    do {
+        const uint64_t now = clockState();
+        claimed = now > last ? now : last + 1;
+        if (claimed >= kStateLimit) {
+            throw std::overflow_error("Id generator timestamp exhausted");
+        }
+    } while (!state.compare_exchange_weak(last, claimed, std::memory_order_relaxed));
+
+    return ((claimed >> kSequenceBits) << (kNodeBits + kSequenceBits))
+         | (uint64_t(node) << kSequenceBits)
+         | (claimed & kSequenceMask);
+}
+
+uint32_t IdGenerator::defaultNode() {
+    char host[256] = {};
+    gethostname(host, sizeof(host) - 1);
+    size_t h = std::hash<std::string_view>{}(host) ^ (static_cast<size_t>(getpid()) * 0x9E3779B97F4A7C15ull);
+    return static_cast<uint32_t>((h ^ (h >> 32)) & kMaxNode);
+}
+
+char* IdGenerator::format(uint64_t id, char* first) {
+    for (size_t i = kFormattedLength; i-- > 0;) {
+        first[i] = kDigits[id & 31];
+        id >>= 5;
+    }
+    return first + kFormattedLength;
+}
+
+std::string IdGenerator::format(uint64_t id) {
+    std::string text(kFormattedLength, '0');
+    format(id, text.data());
+    return text;
+}
+
+std::optional<uint64_t> IdGenerator::parse(std::string_view text) {
+    if (text.size() != kFormattedLength) {
+        return std::nullopt;
+    }
+    // The leading digit holds only the top four bits of 64.
+    int lead = digitValue(text[0]);
+    if (lead < 0 || lead > 15) {
+        return std::nullopt;
+    }
+    uint64_t id = static_cast<uint64_t>(lead);
+    for (size_t i = 1; i < text.size(); ++i) {
+        int value = digitValue(text[i]);
+        if (value < 0) {
+            return std::nullopt;
+        }
+        id = (id << 5) | static_cast<uint64_t>(value);
+    }
+    return id;
+}
+
+int64_t IdGenerator::timestampOf(uint64_t id) {
+    return static_cast<int64_t>(id >> (kNodeBits + kSequenceBits)) + kEpochMillis;
+}
+
+uint32_t IdGenerator::nodeOf(uint64_t id) {
+    return static_cast<uint32_t>((id >> kSequenceBits) & kMaxNode);
+}
+
+uint32_t IdGenerator::sequenceOf(uint64_t id) {
+    return static_cast<uint32_t>(id & kSequenceMask);
+}
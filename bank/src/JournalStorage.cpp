@@ -0,0 +1,456 @@
+#include "JournalStorage.h"
+#include "Account.h"
+#include "Bank.h"
+#include "Crc32.h"
+#include "Ledger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Every record is kRecordSize bytes: a CRC-32 of the other 60 bytes, a kind
+// byte, padding, and a 56-byte payload. Open, Memo and Update records are
+// followed by enough Text records to hold their strings; such a group is
+// only valid if all of it made it to disk.
+enum RecordKind : uint8_t {
+    kHeader = 1,
+    kOpen = 2,
+    kText = 3,
+    kMemo = 4,
+    kPosting = 5,
+    kUpdate = 6,
+};
+
+constexpr size_t kHeaderBytes = 8;
+constexpr size_t kPayloadSize = JournalStorage::kRecordSize - kHeaderBytes;
+constexpr char kMagic[8] = {'F', 'F', 'J', 'O', 'U', 'R', 'N', 'L'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kWriteBufferBytes = 64 * 1024;
+
+struct HeaderPayload {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t byteOrderMark;
+};
+
+// Strings in order: owner, id, username, email.
+struct OpenPayload {
+    uint32_t handle;
+    uint16_t lengths[4];
+    int64_t minimumCents;
+    int64_t initialCents;
+};
+
+// Strings in order: username, email, password.
+struct UpdatePayload {
+    uint32_t handle;
+    uint16_t lengths[3];
+    uint8_t isAdmin;
+};
+
+struct MemoPayload {
+    uint32_t memoId;
+    uint32_t length;
+};
+
+struct PostingPayload {
+    uint32_t source;
+    uint32_t destination;
+    int64_t amountCents;
+    int64_t timestamp;
+    uint32_t memoId;
+    uint8_t type;
+};
+
+static_assert(sizeof(HeaderPayload) <= kPayloadSize, "header fits in one record");
+static_assert(sizeof(OpenPayload) <= kPayloadSize, "open fits in one record");
+static_assert(sizeof(PostingPayload) <= kPayloadSize, "posting fits in one record");
+static_assert(sizeof(UpdatePayload) <= kPayloadSize, "update fits in one record");
+
+uint32_t recordCrc(const unsigned char* record) {
+    return crc32(record + sizeof(uint32_t), JournalStorage::kRecordSize - sizeof(uint32_t));
+}
+
+bool intact(const unsigned char* record) {
+    uint32_t stored;
+    std::memcpy(&stored, record, sizeof(stored));
+    return stored == recordCrc(record);
+}
+
+size_t textRecords(size_t length) {
+    return (length + kPayloadSize - 1) / kPayloadSize;
+}
+
+[[noreturn]] void throwErrno(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+JournalStorage::JournalStorage(const std::string& path) : JournalStorage(path, Options()) {}
+
+JournalStorage::JournalStorage(const std::string& path, Options options)
+    : path(path), fd(-1), options(options), fileBytes(0), unsynced(0), failed(false) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        throwErrno("Cannot open journal", path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throwErrno("Cannot stat journal", path);
+    }
+    fileBytes = static_cast<uint64_t>(info.st_size);
+    if (static_cast<size_t>(info.st_size) < kRecordSize) {
+        // New, or created by a run that crashed before writing the header.
+        HeaderPayload header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.recordSize = kRecordSize;
+        header.byteOrderMark = kByteOrderMark;
+        try {
+            if (::ftruncate(fd, 0) != 0) {
+                throwErrno("Cannot truncate journal", path);
+            }
+            fileBytes = 0;
+            appendRecord(kHeader, &header, sizeof(header));
+            sync();
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+}
+
+JournalStorage::~JournalStorage() {
+    try {
+        sync();
+    } catch (const std::runtime_error&) {
+        // Nothing left to report to; records since the last sync are lost.
+    }
+    ::close(fd);
+}
+
+JournalStorage::Mark JournalStorage::beginRecord() const {
+    if (failed) {
+        throw std::runtime_error("Journal failed earlier: " + path);
+    }
+    return Mark{fileBytes + pending.size(), memoIds.size()};
+}
+
+// Takes back everything the record call that began at mark added. Until a
+// write fails nothing of it has reached the file.
+void JournalStorage::abandon(const Mark& mark) noexcept {
+    for (auto it = memoIds.begin(); it != memoIds.end();) {
+        it = it->second > mark.memos ? memoIds.erase(it) : std::next(it);
+    }
+    if (!failed) {
+        pending.resize(static_cast<size_t>(mark.offset - fileBytes));
+        return;
+    }
+    pending.clear();
+    if (fileBytes > mark.offset && ::ftruncate(fd, static_cast<off_t>(mark.offset)) == 0) {
+        fileBytes = mark.offset;
+    }
+}
+
+void JournalStorage::appendRecord(uint8_t kind, const void* payload, size_t size) {
+    unsigned char record[kRecordSize] = {};
+    record[sizeof(uint32_t)] = kind;
+    std::memcpy(record + kHeaderBytes, payload, size);
+    uint32_t crc = recordCrc(record);
+    std::memcpy(record, &crc, sizeof(crc));
+    pending.insert(pending.end(), record, record + kRecordSize);
+}
+
+void JournalStorage::appendText(std::string_view text) {
+    for (size_t offset = 0; offset < text.size(); offset += kPayloadSize) {
+        size_t chunk = std::min(kPayloadSize, text.size() - offset);
+        appendRecord(kText, text.data() + offset, chunk);
+    }
+}
+
+// Memo ids are local to the journal. Id 0 is the empty memo and is never
+// written; any other memo is written once, before its first posting.
+uint32_t JournalStorage::memoId(std::string_view memo) {
+    if (memo.empty()) {
+        return 0;
+    }
+    auto it = memoIds.find(std::string(memo));
+    if (it != memoIds.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(memoIds.size() + 1);
+    MemoPayload payload{id, static_cast<uint32_t>(memo.size())};
+    appendRecord(kMemo, &payload, sizeof(payload));
+    appendText(memo);
+    memoIds.emplace(std::string(memo), id);
+    return id;
+}
+
+void JournalStorage::recordOpen(const Account& account) {
+    const std::string_view strings[4] = {account.getOwner(), account.getID(), account.getUsername(),
+                                         account.getEmail()};
+    OpenPayload payload{};
+    payload.handle = account.getHandle();
+    payload.minimumCents = account.getMinimum().getCents();
+    payload.initialCents = account.getCurrent().getCents();
+    std::string text;
+    for (int i = 0; i < 4; ++i) {
+        if (strings[i].size() > UINT16_MAX) {
+            throw std::length_error("Account field too long for the journal");
+        }
+        payload.lengths[i] = static_cast<uint16_t>(strings[i].size());
+        text += strings[i];
+    }
+    const Mark mark = beginRecord();
+    try {
+        appendRecord(kOpen, &payload, sizeof(payload));
+        appendText(text);
+        recorded(1);
+    } catch (...) {
+        abandon(mark);
+        throw;
+    }
+}
+
+void JournalStorage::recordUpdate(const Account& account) {
+    const std::string_view strings[3] = {account.getUsername(), account.getEmail(), account.getPassword()};
+    UpdatePayload payload{};
+    payload.handle = account.getHandle();
+    payload.isAdmin = account.isAdmin() ? 1 : 0;
+    std::string text;
+    for (int i = 0; i < 3; ++i) {
+        if (strings[i].size() > UINT16_MAX) {
+            throw std::length_error("Account field too long for the journal");
+        }
+        payload.lengths[i] = static_cast<uint16_t>(strings[i].size());
+        text += strings[i];
+    }
+    const Mark mark = beginRecord();
+    try {
+        appendRecord(kUpdate, &payload, sizeof(payload));
+        appendText(text);
+        recorded(1);
+    } catch (...) {
+        abandon(mark);
+        throw;
+    }
+}
+
+// The rows are buffered together and only then written, so a failure
+// leaves none of them in the journal.
+void JournalStorage::recordPostings(const Ledger& ledger, uint32_t first, uint32_t last) {
+    const Mark mark = beginRecord();
+    try {
+        pending.reserve(pending.size() + size_t(last - first) * kRecordSize);
+        for (uint32_t row = first; row < last; ++row) {
+            PostingPayload payload{};
+            payload.source = ledger.sourceColumn()[row];
+            payload.destination = ledger.destinationColumn()[row];
+            payload.amountCents = ledger.amountColumn()[row];
+            payload.timestamp = ledger.timestampColumn()[row];
+            payload.memoId = memoId(ledger.memoText(ledger.memoColumn()[row]));
+            payload.type = ledger.typeColumn()[row];
+            appendRecord(kPosting, &payload, sizeof(payload));
+        }
+        recorded(last - first);
+    } catch (...) {
+        abandon(mark);
+        throw;
+    }
+}
+
+void JournalStorage::recorded(size_t records) {
+    unsynced += records;
+    if (options.syncEvery != 0 && unsynced >= options.syncEvery) {
+        sync();
+    } else if (pending.size() >= kWriteBufferBytes) {
+        writePending();
+    }
+}
+
+void JournalStorage::writePending() {
+    size_t written = 0;
+    while (written < pending.size()) {
+        ssize_t n = ::write(fd, pending.data() + written, pending.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fileBytes += written;
+            failed = true;
+            pending.clear();
+            throwErrno("Cannot write journal", path);
+        }
+        written += static_cast<size_t>(n);
+    }
+    fileBytes += written;
+    pending.clear();
+}
+
+void JournalStorage::sync() {
+    if (failed) {
+        throw std::runtime_error("Journal failed earlier: " + path);
+    }
+    writePending();
+#ifdef __APPLE__
+    // fsync on macOS does not flush the drive's cache.
+    int result = ::fcntl(fd, F_FULLFSYNC);
+#else
+    int result = ::fdatasync(fd);
+#endif
+    if (result != 0) {
+        // The kernel may have dropped the unsynced pages; nothing written
+        // since the last good sync can be trusted to be there.
+        failed = true;
+        throwErrno("Cannot sync journal", path);
+    }
+    unsynced = 0;
+}
+
+void JournalStorage::load(Bank& bank) {
+    writePending();
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        throwErrno("Cannot stat journal", path);
+    }
+    std::vector<unsigned char> data(static_cast<size_t>(info.st_size));
+    size_t read = 0;
+    while (read < data.size()) {
+        ssize_t n = ::pread(fd, data.data() + read, data.size() - read, static_cast<off_t>(read));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            throwErrno("Cannot read journal", path);
+        }
+        read += static_cast<size_t>(n);
+    }
+
+    const size_t records = data.size() / kRecordSize;
+    auto record = [&data](size_t index) { return data.data() + index * kRecordSize; };
+    auto payload = [&record](size_t index) { return record(index) + kHeaderBytes; };
+
+    HeaderPayload header{};
+    if (records == 0 || !intact(record(0)) || record(0)[sizeof(uint32_t)] != kHeader) {
+        throw std::runtime_error("Not a journal: " + path);
+    }
+    std::memcpy(&header, payload(0), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || header.recordSize != kRecordSize || header.byteOrderMark != kByteOrderMark) {
+        throw std::runtime_error("Unsupported journal format: " + path);
+    }
+
+    // Concatenates the payloads of the Text records that hold `length`
+    // bytes, starting at `first`. Returns the index of the first missing or
+    // damaged one, or `records` if the group runs past the end of the file;
+    // kNoDamage if the text is complete.
+    constexpr size_t kNoDamage = SIZE_MAX;
+    auto readText = [&](size_t first, size_t length, std::string& text) {
+        size_t count = textRecords(length);
+        text.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (first + i >= records) return records;
+            const unsigned char* textRecord = record(first + i);
+            if (!intact(textRecord) || textRecord[sizeof(uint32_t)] != kText) return first + i;
+            size_t chunk = std::min(kPayloadSize, length - i * kPayloadSize);
+            text.append(reinterpret_cast<const char*>(textRecord + kHeaderBytes), chunk);
+        }
+        return kNoDamage;
+    };
+
+    std::vector<std::string> memos(1);
+    std::string text;
+    size_t next = 1;
+    size_t damaged = kNoDamage;
+    size_t groupEnd = 0;
+    while (next < records) {
+        groupEnd = next + 1;
+        if (!intact(record(next))) {
+            damaged = next;
+            break;
+        }
+        uint8_t kind = record(next)[sizeof(uint32_t)];
+        if (kind == kOpen) {
+            OpenPayload open;
+            std::memcpy(&open, payload(next), sizeof(open));
+            size_t length = size_t(open.lengths[0]) + open.lengths[1] + open.lengths[2] + open.lengths[3];
+            groupEnd = next + 1 + textRecords(length);
+            if ((damaged = readText(next + 1, length, text)) != kNoDamage) break;
+            std::string_view fields(text);
+            std::string_view owner = fields.substr(0, open.lengths[0]);
+            std::string_view id = fields.substr(open.lengths[0], open.lengths[1]);
+            std::string_view username = fields.substr(open.lengths[0] + open.lengths[1], open.lengths[2]);
+            std::string_view email = fields.substr(length - open.lengths[3]);
+            Account* account = bank.open(owner, id, Money::fromCents(open.minimumCents),
+                                     Money::fromCents(open.initialCents), username, email);
+            if (account->getHandle() != open.handle) {
+                throw std::runtime_error("Journal opens accounts out of order: " + path);
+            }
+            next += 1 + textRecords(length);
+        } else if (kind == kUpdate) {
+            UpdatePayload update;
+            std::memcpy(&update, payload(next), sizeof(update));
+            size_t length = size_t(update.lengths[0]) + update.lengths[1] + update.lengths[2];
+            groupEnd = next + 1 + textRecords(length);
+            if ((damaged = readText(next + 1, length, text)) != kNoDamage) break;
+            std::string_view fields(text);
+            bank.restoreUpdate(update.handle, fields.substr(0, update.lengths[0]),
+                               fields.substr(update.lengths[0], update.lengths[1]),
+                               std::string(fields.substr(length - update.lengths[2])), update.isAdmin != 0);
+            next += 1 + textRecords(length);
+        } else if (kind == kMemo) {
+            MemoPayload memo;
+            std::memcpy(&memo, payload(next), sizeof(memo));
+            if (memo.memoId != memos.size()) {
+                throw std::runtime_error("Journal memos are out of order: " + path);
+            }
+            groupEnd = next + 1 + textRecords(memo.length);
+            if ((damaged = readText(next + 1, memo.length, text)) != kNoDamage) break;
+            memos.push_back(text);
+            next += 1 + textRecords(memo.length);
+        } else if (kind == kPosting) {
+            PostingPayload posting;
+            std::memcpy(&posting, payload(next), sizeof(posting));
+            if (posting.memoId >= memos.size()) {
+                throw std::runtime_error("Journal posting refers to an unknown memo: " + path);
+            }
+            bank.restorePosting(posting.source, posting.destination, posting.amountCents, posting.timestamp,
+                                static_cast<Transaction::Type>(posting.type), memos[posting.memoId]);
+            next += 1;
+        } else {
+            throw std::runtime_error("Journal has a record of unknown kind: " + path);
+        }
+    }
+
+    // A crash mid-write can only damage the last group written. Damage
+    // followed by intact records of later groups is corruption, and cutting
+    // there would throw those records away with it.
+    if (damaged != kNoDamage) {
+        for (size_t i = std::max(damaged + 1, groupEnd); i < records; ++i) {
+            if (intact(record(i))) {
+                throw std::runtime_error("Journal is damaged before its end: " + path);
+            }
+        }
+    }
+
+    // Anything past the last complete group is a torn write; cut it off so
+    // new records follow directly.
+    if (next * kRecordSize < data.size()) {
+        if (::ftruncate(fd, static_cast<off_t>(next * kRecordSize)) != 0) {
+            throwErrno("Cannot truncate journal", path);
+        }
+        fileBytes = next * kRecordSize;
+        sync();
+    }
+
+    memoIds.clear();
+    for (uint32_t id = 1; id < memos.size(); ++id) {
+        memoIds.emplace(memos[id], id);
+    }
+}
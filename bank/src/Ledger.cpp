@@ -0,0 +1,125 @@
+#include "Ledger.h"
+#include "Timestamp.h"
+#include <algorithm>
+#include <stdexcept>
+
+uint32_t LedgerEntry::getSource() const { return ledger->sourceColumn()[row]; }
+uint32_t LedgerEntry::getDestination() const { return ledger->destinationColumn()[row]; }
+Money LedgerEntry::getAmount() const { return Money::fromCents(ledger->amountColumn()[row]); }
+int64_t LedgerEntry::getTimestamp() const { return ledger->timestampColumn()[row]; }
+
+std::string LedgerEntry::getDate() const {
+    return formatTimestamp(getTimestamp());
+}
+
+Transaction::Type LedgerEntry::getType() const {
+    return static_cast<Transaction::Type>(ledger->typeColumn()[row]);
+}
+
+std::string_view LedgerEntry::getMemo() const {
+    return ledger->memoText(ledger->memoColumn()[row]);
+}
+
+Ledger::Ledger() : storage(nullptr) {
+    // Memo id 0 is always the empty memo.
+    internMemo("");
+}
+
+uint32_t Ledger::append(uint32_t source, uint32_t destination, int64_t amountCents,
+                        int64_t timestamp, Transaction::Type type, std::string_view memo) {
+    uint32_t row = appendUnrecorded(source, destination, amountCents, timestamp, type, memo);
+    try {
+        recordRows(row);
+    } catch (...) {
+        truncate(row);
+        throw;
+    }
+    return row;
+}
+
+uint32_t Ledger::appendUnrecorded(uint32_t source, uint32_t destination, int64_t amountCents,
+                                  int64_t timestamp, Transaction::Type type, std::string_view memo) {
+    if (amounts.size() >= UINT32_MAX) {
+        throw std::length_error("Ledger is full");
+    }
+    if (!timestamps.empty()) {
+        timestamp = std::max(timestamp, timestamps.back());
+    }
+    uint32_t row = static_cast<uint32_t>(amounts.size());
+    uint32_t memoId = internMemo(memo);
+    try {
+        sources.push_back(source);
+        destinations.push_back(destination);
+        amounts.push_back(amountCents);
+        timestamps.push_back(timestamp);
+        types.push_back(static_cast<uint8_t>(type));
+        memoIds.push_back(memoId);
+    } catch (...) {
+        truncate(row);
+        throw;
+    }
+    return row;
+}
+
+void Ledger::recordRows(uint32_t first) const {
+    if (storage != nullptr && first < amounts.size()) {
+        storage->recordPostings(*this, first, static_cast<uint32_t>(amounts.size()));
+    }
+}
+
+void Ledger::truncate(size_t rows) {
+    sources.resize(std::min(sources.size(), rows));
+    destinations.resize(std::min(destinations.size(), rows));
+    amounts.resize(std::min(amounts.size(), rows));
+    timestamps.resize(std::min(timestamps.size(), rows));
+    types.resize(std::min(types.size(), rows));
+    memoIds.resize(std::min(memoIds.size(), rows));
+}
+
+void Ledger::reserve(size_t rows) {
+    sources.reserve(rows);
+    destinations.reserve(rows);
+    amounts.reserve(rows);
+    timestamps.reserve(rows);
+    types.reserve(rows);
+    memoIds.reserve(rows);
+}
+
+void Ledger::setStorage(Storage* storage) {
+    this->storage = storage;
+}
+
+std::pair<uint32_t, uint32_t> Ledger::rowsBetween(int64_t from, int64_t to) const {
+    auto first = std::lower_bound(timestamps.begin(), timestamps.end(), from);
+    auto last = std::lower_bound(first, timestamps.end(), to);
+    return {static_cast<uint32_t>(first - timestamps.begin()), static_cast<uint32_t>(last - timestamps.begin())};
+}
+
+int64_t Ledger::sumAmounts(uint32_t first, uint32_t last) const {
+    int64_t total = 0;
+    for (uint32_t i = first; i < last; ++i) {
+        total += amounts[i];
+    }
+    return total;
+}
+
+int64_t Ledger::netFlow(uint32_t account, uint32_t first, uint32_t last) const {
+    // Branch-free so the loop vectorizes over the three columns.
+    int64_t total = 0;
+    for (uint32_t i = first; i < last; ++i) {
+        int64_t sign = static_cast<int64_t>(destinations[i] == account) - static_cast<int64_t>(sources[i] == account);
+        total += sign * amounts[i];
+    }
+    return total;
+}
+
+uint32_t Ledger::internMemo(std::string_view memo) {
+    auto it = memoLookup.find(memo);
+    if (it != memoLookup.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(memos.size());
+    memos.emplace_back(memo);
+    memoLookup.emplace(memos.back(), id);
+    return id;
+}
@@ -0,0 +1,126 @@
+#include "LedgerWriter.h"
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+// Idle strategy for both sides: spin briefly, then yield, then sleep, so an
+// idle writer does not burn a core but a busy one never parks.
+class Backoff {
+public:
+    void pause() {
+        if (++attempts < 64) {
+            return;
+        }
+        if (attempts < 1024) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    void reset() { attempts = 0; }
+
+private:
+    unsigned attempts = 0;
+};
+}
+
+LedgerWriter::LedgerWriter(Bank& bank, size_t capacity)
+    : bank(bank), queue(capacity), running(true), publishing(0), writer(&LedgerWriter::run, this) {}
+
+LedgerWriter::~LedgerWriter() {
+    stop();
+}
+
+std::future<TransactionResult> LedgerWriter::submit(TransactionRequest request) {
+    Command command;
+    command.request = std::move(request);
+    command.hasPromise = true;
+    std::future<TransactionResult> result = command.promise.get_future();
+    push(command, true);
+    return result;
+}
+
+void LedgerWriter::submit(TransactionRequest request, Callback callback) {
+    Command command;
+    command.request = std::move(request);
+    command.callback = std::move(callback);
+    push(command, true);
+}
+
+bool LedgerWriter::trySubmit(TransactionRequest& request, Callback callback) {
+    Command command;
+    command.request = std::move(request);
+    command.callback = std::move(callback);
+    if (push(command, false)) {
+        return true;
+    }
+    request = std::move(command.request);
+    return false;
+}
+
+bool LedgerWriter::push(Command& command, bool wait) {
+    // Announce the push before checking running, so a writer that has seen
+    // stop() also sees this push in flight and waits for it.
+    publishing.fetch_add(1);
+    if (!running.load()) {
+        publishing.fetch_sub(1);
+        throw std::logic_error("LedgerWriter is stopped");
+    }
+    bool pushed = queue.tryPush(command);
+    Backoff backoff;
+    while (!pushed && wait) {
+        backoff.pause();
+        pushed = queue.tryPush(command);
+    }
+    publishing.fetch_sub(1);
+    return pushed;
+}
+
+void LedgerWriter::stop() {
+    if (running.exchange(false) && writer.joinable()) {
+        writer.join();
+    }
+}
+
+void LedgerWriter::run() {
+    Command command;
+    Backoff backoff;
+    for (;;) {
+        if (queue.tryPop(command)) {
+            execute(command);
+            backoff.reset();
+        } else if (!running.load()) {
+            // Producers that passed their running check may still be pushing.
+            for (;;) {
+                const bool idle = publishing.load() == 0;
+                if (queue.tryPop(command)) {
+                    execute(command);
+                } else if (idle) {
+                    return;
+                } else {
+                    backoff.pause();
+                }
+            }
+        } else {
+            backoff.pause();
+        }
+    }
+}
+
+void LedgerWriter::execute(Command& command) {
+    TransactionResult result = bank.transfer(command.request);
+    if (result.status == TransactionStatus::UnknownAccount || result.status == TransactionStatus::SameAccount) {
+        // Those IDs point into the request, which is about to be reused.
+        result.accountId = {};
+    }
+    if (command.hasPromise) {
+        command.promise.set_value(result);
+    } else if (command.callback) {
+        try {
+            command.callback(result);
+        } catch (...) {
+            // Nobody is left to report to; keep the writer alive.
+        }
+    }
+    command = Command();
+}
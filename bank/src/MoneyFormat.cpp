@@ -0,0 +1,22 @@
+#include "MoneyFormat.h"
+
+MoneyColumn::MoneyColumn(MoneyStyle style) : style(style), offsets{0} {}
+
+void MoneyColumn::clear() {
+    arena.clear();
+    offsets.assign(1, 0);
+}
+
+void MoneyColumn::reserve(size_t count) {
+    // Typical balances are well under the worst case; grow if they are not.
+    arena.reserve(count * 12);
+    offsets.reserve(count + 1);
+}
+
+void MoneyColumn::append(int64_t cents) {
+    const size_t used = arena.size();
+    arena.resize(used + kMaxMoneyChars);
+    char* end = formatMoney(arena.data() + used, arena.data() + arena.size(), cents, style);
+    arena.resize(static_cast<size_t>(end - arena.data()));
+    offsets.push_back(static_cast<uint32_t>(arena.size()));
+}
@@ -1,12 +1,16 @@
 #include "OverdraftException.h"
+#include "Account.h"
 
 OverdraftException::OverdraftException(const Account& account, const Money& amount)
-    : std::runtime_error("Overdraft of " + account.getID() + " by " + amount.toString()),
-      account(account), amount(amount) {
-    if (amount.compareTo(Money::fromCents(0)) <= 0) {
+    : OverdraftException(account.getID(), amount) {}
+
+OverdraftException::OverdraftException(std::string_view accountId, const Money& amount)
+    : std::runtime_error("Overdraft of " + std::string(accountId) + " by " + amount.toString()),
+      accountId(accountId), amount(amount) {
+    if (amount <= Money::fromCents(0)) {
         throw std::invalid_argument("Overdrawn amount must be positive");
     }
 }
 
-const Account& OverdraftException::getAccount() const { return account; }
-Money OverdraftException::getAmount() const { return amount; }
\ No newline at end of file
+const std::string& OverdraftException::getAccountId() const { return accountId; }
+Money OverdraftException::getAmount() const { return amount; }
@@ -0,0 +1,198 @@
+#include "PasswordHasher.h"
+#include "Scrypt.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <sys/random.h>
+
+namespace {
+
+constexpr std::string_view kPrefix = "$scrypt$";
+constexpr char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+// No 0/O, 1/l/I: generated passwords get read off a dialog and retyped.
+constexpr char kPasswordAlphabet[] = "abcdefghijkmnpqrstuvwxyzABCDEFGHJKLMNPQRSTUVWXYZ23456789";
+// Stored hashes come from our own database, but a corrupted one must not be
+// able to ask for unbounded work.
+constexpr uint32_t kMaxR = 32;
+constexpr uint32_t kMaxP = 16;
+
+// Everything hash() accepts and scrypt() can run, so a parsed hash never
+// makes verify() throw.
+bool validParams(PasswordHasher::Params params) {
+    return params.log2N >= 1 && params.log2N <= 30 && params.r != 0 && params.r <= kMaxR && params.p != 0
+        && params.p <= kMaxP && params.memoryBytes() <= kScryptMaxScratch;
+}
+
+struct Parsed {
+    PasswordHasher::Params params;
+    std::string salt;
+    std::string hash;
+};
+
+std::string encodeBase64(const uint8_t* data, size_t size) {
+    std::string text;
+    text.reserve((size * 4 + 2) / 3);
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t chunk = uint32_t(data[i]) << 16;
+        if (i + 1 < size) chunk |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) chunk |= data[i + 2];
+        size_t digits = std::min<size_t>(4, (size - i) * 4 / 3 + ((size - i) < 3));
+        for (size_t k = 0; k < digits; ++k) {
+            text += kBase64[(chunk >> (18 - 6 * k)) & 63];
+        }
+    }
+    return text;
+}
+
+std::optional<std::string> decodeBase64(std::string_view text) {
+    std::string data;
+    uint32_t chunk = 0;
+    int bits = 0;
+    for (char c : text) {
+        const char* found = std::strchr(kBase64, c);
+        if (c == '\0' || found == nullptr) {
+            return std::nullopt;
+        }
+        chunk = (chunk << 6) | uint32_t(found - kBase64);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            data += char((chunk >> bits) & 0xFF);
+        }
+    }
+    return data;
+}
+
+std::optional<uint32_t> parseNumber(std::string_view text, std::string_view key) {
+    if (text.substr(0, key.size()) != key || text.size() == key.size() || text.size() > key.size() + 9) {
+        return std::nullopt;
+    }
+    uint32_t value = 0;
+    for (char c : text.substr(key.size())) {
+        if (c < '0' || c > '9') return std::nullopt;
+        value = value * 10 + uint32_t(c - '0');
+    }
+    return value;
+}
+
+std::optional<Parsed> parse(std::string_view stored) {
+    if (stored.substr(0, kPrefix.size()) != kPrefix) {
+        return std::nullopt;
+    }
+    stored.remove_prefix(kPrefix.size());
+    std::string_view fields[3];
+    for (int i = 0; i < 3; ++i) {
+        size_t end = i < 2 ? stored.find('$') : stored.size();
+        if (end == std::string_view::npos) return std::nullopt;
+        fields[i] = stored.substr(0, end);
+        stored.remove_prefix(i < 2 ? end + 1 : end);
+    }
+
+    std::string_view params = fields[0];
+    size_t first = params.find(',');
+    size_t second = first == std::string_view::npos ? first : params.find(',', first + 1);
+    if (second == std::string_view::npos) return std::nullopt;
+    auto log2N = parseNumber(params.substr(0, first), "ln=");
+    auto r = parseNumber(params.substr(first + 1, second - first - 1), "r=");
+    auto p = parseNumber(params.substr(second + 1), "p=");
+    auto salt = decodeBase64(fields[1]);
+    auto hash = decodeBase64(fields[2]);
+    if (!log2N || !r || !p || !salt || !hash || !validParams({*log2N, *r, *p})
+        || hash->size() != PasswordHasher::kHashSize) {
+        return std::nullopt;
+    }
+    return Parsed{{*log2N, *r, *p}, std::move(*salt), std::move(*hash)};
+}
+
+void derive(std::string_view password, const std::string& salt, PasswordHasher::Params params,
+            uint8_t out[PasswordHasher::kHashSize]) {
+    scrypt(reinterpret_cast<const uint8_t*>(password.data()), password.size(),
+           reinterpret_cast<const uint8_t*>(salt.data()), salt.size(),
+           uint64_t(1) << params.log2N, params.r, params.p, out, PasswordHasher::kHashSize);
+}
+
+} // namespace
+
+std::string PasswordHasher::hash(std::string_view password, Params params) {
+    if (!validParams(params)) {
+        throw std::invalid_argument("Invalid password hash parameters");
+    }
+    uint8_t salt[kSaltSize];
+    randomBytes(salt, sizeof(salt));
+    uint8_t derived[kHashSize];
+    derive(password, std::string(reinterpret_cast<const char*>(salt), sizeof(salt)), params, derived);
+    return std::string(kPrefix) + "ln=" + std::to_string(params.log2N) + ",r=" + std::to_string(params.r)
+         + ",p=" + std::to_string(params.p) + "$" + encodeBase64(salt, sizeof(salt)) + "$"
+         + encodeBase64(derived, sizeof(derived));
+}
+
+bool PasswordHasher::verify(std::string_view password, std::string_view stored) {
+    if (std::optional<Parsed> parsed = parse(stored)) {
+        uint8_t derived[kHashSize];
+        derive(password, parsed->salt, parsed->params, derived);
+        return constantTimeEquals(derived, reinterpret_cast<const uint8_t*>(parsed->hash.data()), kHashSize);
+    }
+
+    if (stored.empty() || stored.substr(0, kDisabled.size()) == kDisabled || stored.substr(0, 1) == "$") {
+        // Spend what a real check would, so a missing or disabled account
+        // cannot be told apart by timing.
+        uint8_t derived[kHashSize];
+        derive(password, std::string(kSaltSize, '\0'), Params::interactive(), derived);
+        return false;
+    }
+
+    // Legacy plaintext: comparing digests keeps the time independent of
+    // where, or whether, the lengths differ.
+    uint8_t expected[Sha256::kDigestSize];
+    uint8_t actual[Sha256::kDigestSize];
+    Sha256::hash(reinterpret_cast<const uint8_t*>(stored.data()), stored.size(), expected);
+    Sha256::hash(reinterpret_cast<const uint8_t*>(password.data()), password.size(), actual);
+    return constantTimeEquals(expected, actual, sizeof(expected));
+}
+
+bool PasswordHasher::needsRehash(std::string_view stored, Params params) {
+    if (std::optional<Parsed> parsed = parse(stored)) {
+        return parsed->params.log2N < params.log2N || parsed->params.r < params.r || parsed->params.p < params.p;
+    }
+    return !stored.empty() && stored.substr(0, kDisabled.size()) != kDisabled;
+}
+
+std::string PasswordHasher::generatePassword(size_t length) {
+    constexpr size_t kAlphabetSize = sizeof(kPasswordAlphabet) - 1;
+    // Rejection sampling: bytes at or above the largest multiple of the
+    // alphabet size would bias the first characters.
+    constexpr unsigned kLimit = 256 - 256 % kAlphabetSize;
+    std::string password;
+    password.reserve(length);
+    uint8_t bytes[64];
+    while (password.size() < length) {
+        randomBytes(bytes, sizeof(bytes));
+        for (size_t i = 0; i < sizeof(bytes) && password.size() < length; ++i) {
+            if (bytes[i] < kLimit) {
+                password += kPasswordAlphabet[bytes[i] % kAlphabetSize];
+            }
+        }
+    }
+    return password;
+}
+
+void PasswordHasher::randomBytes(uint8_t* data, size_t size) {
+    // getentropy() returns at most 256 bytes per call.
+    while (size > 0) {
+        size_t take = std::min<size_t>(size, 256);
+        if (getentropy(data, take) != 0) {
+            throw std::runtime_error("No OS entropy source available");
+        }
+        data += take;
+        size -= take;
+    }
+}
+
+bool PasswordHasher::constantTimeEquals(const uint8_t* a, const uint8_t* b, size_t size) {
+    volatile uint8_t difference = 0;
+    for (size_t i = 0; i < size; ++i) {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
@@ -0,0 +1,247 @@
+#include "Scrypt.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+inline uint32_t rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+inline uint32_t loadBigEndian(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+inline void storeBigEndian(uint8_t* p, uint32_t x) {
+    p[0] = uint8_t(x >> 24);
+    p[1] = uint8_t(x >> 16);
+    p[2] = uint8_t(x >> 8);
+    p[3] = uint8_t(x);
+}
+
+inline uint32_t loadLittleEndian(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+inline void storeLittleEndian(uint8_t* p, uint32_t x) {
+    p[0] = uint8_t(x);
+    p[1] = uint8_t(x >> 8);
+    p[2] = uint8_t(x >> 16);
+    p[3] = uint8_t(x >> 24);
+}
+
+// HMAC-SHA256 with the padded key absorbed once, so each PBKDF2 block only
+// copies two hash states.
+class HmacSha256 {
+public:
+    HmacSha256(const uint8_t* key, size_t keySize) {
+        uint8_t block[Sha256::kBlockSize] = {};
+        if (keySize > Sha256::kBlockSize) {
+            Sha256::hash(key, keySize, block);
+        } else if (keySize > 0) {
+            std::memcpy(block, key, keySize);
+        }
+        uint8_t pad[Sha256::kBlockSize];
+        for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = block[i] ^ 0x36;
+        inner.update(pad, sizeof(pad));
+        for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = block[i] ^ 0x5c;
+        outer.update(pad, sizeof(pad));
+    }
+
+    Sha256 begin() const { return inner; }
+
+    void finish(Sha256& context, uint8_t digest[Sha256::kDigestSize]) const {
+        uint8_t innerDigest[Sha256::kDigestSize];
+        context.finish(innerDigest);
+        Sha256 result = outer;
+        result.update(innerDigest, sizeof(innerDigest));
+        result.finish(digest);
+    }
+
+private:
+    Sha256 inner;
+    Sha256 outer;
+};
+
+void salsa20_8(uint32_t b[16]) {
+    uint32_t x[16];
+    std::memcpy(x, b, sizeof(x));
+    for (int i = 0; i < 8; i += 2) {
+        x[4] ^= rotl(x[0] + x[12], 7);   x[8] ^= rotl(x[4] + x[0], 9);
+        x[12] ^= rotl(x[8] + x[4], 13);  x[0] ^= rotl(x[12] + x[8], 18);
+        x[9] ^= rotl(x[5] + x[1], 7);    x[13] ^= rotl(x[9] + x[5], 9);
+        x[1] ^= rotl(x[13] + x[9], 13);  x[5] ^= rotl(x[1] + x[13], 18);
+        x[14] ^= rotl(x[10] + x[6], 7);  x[2] ^= rotl(x[14] + x[10], 9);
+        x[6] ^= rotl(x[2] + x[14], 13);  x[10] ^= rotl(x[6] + x[2], 18);
+        x[3] ^= rotl(x[15] + x[11], 7);  x[7] ^= rotl(x[3] + x[15], 9);
+        x[11] ^= rotl(x[7] + x[3], 13);  x[15] ^= rotl(x[11] + x[7], 18);
+        x[1] ^= rotl(x[0] + x[3], 7);    x[2] ^= rotl(x[1] + x[0], 9);
+        x[3] ^= rotl(x[2] + x[1], 13);   x[0] ^= rotl(x[3] + x[2], 18);
+        x[6] ^= rotl(x[5] + x[4], 7);    x[7] ^= rotl(x[6] + x[5], 9);
+        x[4] ^= rotl(x[7] + x[6], 13);   x[5] ^= rotl(x[4] + x[7], 18);
+        x[11] ^= rotl(x[10] + x[9], 7);  x[8] ^= rotl(x[11] + x[10], 9);
+        x[9] ^= rotl(x[8] + x[11], 13);  x[10] ^= rotl(x[9] + x[8], 18);
+        x[12] ^= rotl(x[15] + x[14], 7); x[13] ^= rotl(x[12] + x[15], 9);
+        x[14] ^= rotl(x[13] + x[12], 13); x[15] ^= rotl(x[14] + x[13], 18);
+    }
+    for (int i = 0; i < 16; ++i) b[i] += x[i];
+}
+
+// scryptBlockMix over 2r 64-byte blocks; in and out must not overlap.
+void blockMix(const uint32_t* in, uint32_t* out, uint32_t r) {
+    uint32_t x[16];
+    std::memcpy(x, in + (2 * r - 1) * 16, sizeof(x));
+    for (uint32_t i = 0; i < 2 * r; ++i) {
+        for (int k = 0; k < 16; ++k) x[k] ^= in[i * 16 + k];
+        salsa20_8(x);
+        // Even blocks go to the first half of the output, odd ones to the second.
+        std::memcpy(out + ((i / 2) + (i % 2) * r) * 16, x, sizeof(x));
+    }
+}
+
+void roMix(uint8_t* block, uint64_t n, uint32_t r, uint32_t* v, uint32_t* x, uint32_t* y) {
+    const size_t words = 32 * size_t(r);
+    for (size_t k = 0; k < words; ++k) x[k] = loadLittleEndian(block + 4 * k);
+    for (uint64_t i = 0; i < n; ++i) {
+        std::memcpy(v + i * words, x, words * sizeof(uint32_t));
+        blockMix(x, y, r);
+        std::memcpy(x, y, words * sizeof(uint32_t));
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t j = x[(2 * r - 1) * 16] & (n - 1);
+        const uint32_t* vj = v + j * words;
+        for (size_t k = 0; k < words; ++k) x[k] ^= vj[k];
+        blockMix(x, y, r);
+        std::memcpy(x, y, words * sizeof(uint32_t));
+    }
+    for (size_t k = 0; k < words; ++k) storeLittleEndian(block + 4 * k, x[k]);
+}
+
+} // namespace
+
+Sha256::Sha256()
+    : state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+      length(0), buffer{}, buffered(0) {}
+
+void Sha256::compress(const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) w[i] = loadBigEndian(block + 4 * i);
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + kRoundConstants[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void Sha256::update(const uint8_t* data, size_t size) {
+    length += size;
+    if (buffered > 0) {
+        size_t take = std::min(size, kBlockSize - buffered);
+        std::memcpy(buffer + buffered, data, take);
+        buffered += take;
+        data += take;
+        size -= take;
+        if (buffered < kBlockSize) {
+            return;
+        }
+        compress(buffer);
+        buffered = 0;
+    }
+    for (; size >= kBlockSize; data += kBlockSize, size -= kBlockSize) {
+        compress(data);
+    }
+    if (size > 0) {
+        std::memcpy(buffer, data, size);
+        buffered = size;
+    }
+}
+
+void Sha256::finish(uint8_t digest[kDigestSize]) {
+    const uint64_t bits = length * 8;
+    const uint8_t one = 0x80;
+    update(&one, 1);
+    const uint8_t zero = 0;
+    while (buffered != kBlockSize - 8) {
+        update(&zero, 1);
+    }
+    uint8_t trailer[8];
+    for (int i = 0; i < 8; ++i) trailer[i] = uint8_t(bits >> (56 - 8 * i));
+    update(trailer, sizeof(trailer));
+    for (int i = 0; i < 8; ++i) storeBigEndian(digest + 4 * i, state[i]);
+}
+
+void Sha256::hash(const uint8_t* data, size_t size, uint8_t digest[kDigestSize]) {
+    Sha256 context;
+    context.update(data, size);
+    context.finish(digest);
+}
+
+void pbkdf2Sha256(const uint8_t* password, size_t passwordSize, const uint8_t* salt, size_t saltSize,
+                  uint32_t iterations, uint8_t* out, size_t outSize) {
+    if (iterations == 0) {
+        throw std::invalid_argument("PBKDF2 needs at least one iteration");
+    }
+    const HmacSha256 hmac(password, passwordSize);
+    uint8_t u[Sha256::kDigestSize];
+    uint8_t t[Sha256::kDigestSize];
+    for (uint32_t blockIndex = 1; outSize > 0; ++blockIndex) {
+        uint8_t counter[4];
+        storeBigEndian(counter, blockIndex);
+        Sha256 context = hmac.begin();
+        context.update(salt, saltSize);
+        context.update(counter, sizeof(counter));
+        hmac.finish(context, u);
+        std::memcpy(t, u, sizeof(t));
+        for (uint32_t i = 1; i < iterations; ++i) {
+            context = hmac.begin();
+            context.update(u, sizeof(u));
+            hmac.finish(context, u);
+            for (size_t k = 0; k < sizeof(t); ++k) t[k] ^= u[k];
+        }
+        size_t take = std::min(outSize, sizeof(t));
+        std::memcpy(out, t, take);
+        out += take;
+        outSize -= take;
+    }
+}
+
+void scrypt(const uint8_t* password, size_t passwordSize, const uint8_t* salt, size_t saltSize,
+            uint64_t n, uint32_t r, uint32_t p, uint8_t* out, size_t outSize) {
+    if (n < 2 || (n & (n - 1)) != 0 || r == 0 || p == 0 || uint64_t(r) * p >= (uint64_t(1) << 30)
+        || n > kScryptMaxScratch / (128 * uint64_t(r))) {
+        throw std::invalid_argument("Invalid scrypt parameters");
+    }
+    const size_t blockSize = 128 * size_t(r);
+    std::vector<uint8_t> blocks(blockSize * p);
+    pbkdf2Sha256(password, passwordSize, salt, saltSize, 1, blocks.data(), blocks.size());
+
+    std::vector<uint32_t> v(size_t(n) * 32 * r);
+    std::vector<uint32_t> x(32 * size_t(r));
+    std::vector<uint32_t> y(32 * size_t(r));
+    for (uint32_t i = 0; i < p; ++i) {
+        roMix(blocks.data() + i * blockSize, n, r, v.data(), x.data(), y.data());
+    }
+    pbkdf2Sha256(password, passwordSize, blocks.data(), blocks.size(), 1, out, outSize);
+}
@@ -0,0 +1,102 @@
+#include "StringPool.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+constexpr size_t kMinCapacity = 16;
+// Owner names, usernames and emails are short; 16 KiB blocks keep a small
+// pool small without making large ones allocate often.
+constexpr size_t kTextBlockSize = 16 * 1024;
+}
+
+StringPool::StringPool() : text(kTextBlockSize) {
+    strings.push_back(std::string_view());
+    hashes.push_back(0);
+}
+
+uint32_t StringPool::hashOf(std::string_view text) {
+    size_t h = std::hash<std::string_view>{}(text);
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+size_t StringPool::slotOf(std::string_view key, uint32_t hash) const {
+    const size_t mask = table.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        if (table[i] == kEmpty || (hashes[table[i]] == hash && strings[table[i]] == key)) {
+            return i;
+        }
+    }
+}
+
+StringPool::Id StringPool::find(std::string_view key) const {
+    if (key.empty() || table.empty()) {
+        return kEmpty;
+    }
+    return table[slotOf(key, hashOf(key))];
+}
+
+StringPool::Id StringPool::intern(std::string_view key) {
+    if (key.empty()) {
+        return kEmpty;
+    }
+    if (strings.size() * 2 > table.size()) {
+        rehash(std::max(kMinCapacity, table.size() * 2));
+    }
+    const uint32_t hash = hashOf(key);
+    size_t slot = slotOf(key, hash);
+    if (table[slot] != kEmpty) {
+        return table[slot];
+    }
+    if (strings.size() >= UINT32_MAX) {
+        throw std::length_error("String pool is full");
+    }
+    Id id = static_cast<Id>(strings.size());
+    strings.push_back(text.copy(key));
+    hashes.push_back(hash);
+    table[slot] = id;
+    return id;
+}
+
+std::string_view StringPool::view(Id id) const {
+    if (id >= strings.size()) {
+        throw std::out_of_range("Unknown string pool id");
+    }
+    return strings[id];
+}
+
+size_t StringPool::bytesReserved() const {
+    return text.bytesReserved() + strings.capacity() * sizeof(std::string_view)
+         + table.capacity() * sizeof(Id) + hashes.capacity() * sizeof(uint32_t);
+}
+
+void StringPool::reserve(size_t count) {
+    strings.reserve(count + 1);
+    hashes.reserve(count + 1);
+    size_t capacity = kMinCapacity;
+    while (capacity < (count + 1) * 2) {
+        capacity *= 2;
+    }
+    if (capacity > table.size()) {
+        rehash(capacity);
+    }
+}
+
+void StringPool::clear() {
+    text.reset();
+    strings.resize(1);
+    hashes.resize(1);
+    std::fill(table.begin(), table.end(), kEmpty);
+}
+
+void StringPool::rehash(size_t capacity) {
+    table.assign(capacity, kEmpty);
+    const size_t mask = capacity - 1;
+    for (Id id = 1; id < strings.size(); ++id) {
+        size_t i = hashes[id] & mask;
+        while (table[i] != kEmpty) {
+            i = (i + 1) & mask;
+        }
+        table[i] = id;
+    }
+}
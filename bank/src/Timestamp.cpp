@@ -0,0 +1,122 @@
+#include "Timestamp.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <ctime>
+
+namespace {
+
+constexpr int64_t kSecondsPerDay = 86400;
+// When the offset changes during a day, only a window this long around the
+// timestamp is cached. Zones only switch on quarter-hour boundaries.
+constexpr int64_t kTransitionWindow = 900;
+
+int64_t floorDiv(int64_t a, int64_t b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+// Seconds east of UTC in force at the given instant.
+int64_t utcOffsetAt(int64_t seconds) {
+    const std::time_t time = static_cast<std::time_t>(seconds);
+    std::tm local{};
+    if (localtime_r(&time, &local) == nullptr) {
+        return 0;
+    }
+    return local.tm_gmtoff;
+}
+
+char* writeTwoDigits(char* out, unsigned value) {
+    out[0] = static_cast<char>('0' + value / 10);
+    out[1] = static_cast<char>('0' + value % 10);
+    return out + 2;
+}
+
+// Renders days since 1970-01-01 as "YYYY-MM-DD" (proleptic Gregorian).
+char* writeDate(char* out, char* last, int64_t days) {
+    days += 719468;
+    const int64_t era = floorDiv(days, 146097);
+    const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+    const unsigned day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    const unsigned month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    const int64_t year = static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2);
+
+    if (year >= 0 && year <= 9999) {
+        const unsigned y = static_cast<unsigned>(year);
+        out = writeTwoDigits(out, y / 100);
+        out = writeTwoDigits(out, y % 100);
+    } else {
+        out = std::to_chars(out, last, year).ptr;
+    }
+    *out++ = '-';
+    out = writeTwoDigits(out, month);
+    *out++ = '-';
+    return writeTwoDigits(out, day);
+}
+
+// The local day a thread last rendered. Instants in [begin, end) share its
+// date text and one UTC offset, so their time of day is seconds - midnight.
+struct DayCache {
+    int64_t begin = 0;
+    int64_t end = 0;
+    int64_t midnight = 0;
+    size_t dateLength = 0;
+    char date[kMaxTimestampChars];
+};
+
+const DayCache& dayContaining(int64_t seconds) {
+    thread_local DayCache cache;
+    if (seconds >= cache.begin && seconds < cache.end) {
+        return cache;
+    }
+
+    const int64_t offset = utcOffsetAt(seconds);
+    const int64_t localDay = floorDiv(seconds + offset, kSecondsPerDay);
+    cache.midnight = localDay * kSecondsPerDay - offset;
+    cache.begin = cache.midnight;
+    cache.end = cache.midnight + kSecondsPerDay;
+    if (utcOffsetAt(cache.begin) != offset || utcOffsetAt(cache.end - 1) != offset) {
+        const int64_t window = floorDiv(seconds, kTransitionWindow) * kTransitionWindow;
+        cache.begin = std::max(cache.begin, window);
+        cache.end = std::min(cache.end, window + kTransitionWindow);
+        if (utcOffsetAt(cache.begin) != offset || utcOffsetAt(cache.end - 1) != offset) {
+            cache.begin = seconds;
+            cache.end = seconds + 1;
+        }
+    }
+    char* end = writeDate(cache.date, cache.date + sizeof(cache.date), localDay);
+    cache.dateLength = static_cast<size_t>(end - cache.date);
+    return cache;
+}
+
+} // namespace
+
+int64_t currentTimestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+char* formatTimestamp(char* first, char* last, int64_t micros, TimestampStyle style) {
+    const int64_t seconds = floorDiv(micros, 1000000);
+    const DayCache& day = dayContaining(seconds);
+    const size_t length = day.dateLength + 9;
+    if (static_cast<size_t>(last - first) < length) {
+        return nullptr;
+    }
+
+    const unsigned secondOfDay = static_cast<unsigned>(seconds - day.midnight);
+    char* out = std::copy(day.date, day.date + day.dateLength, first);
+    *out++ = style == TimestampStyle::Iso8601 ? 'T' : ' ';
+    out = writeTwoDigits(out, secondOfDay / 3600);
+    *out++ = ':';
+    out = writeTwoDigits(out, secondOfDay / 60 % 60);
+    *out++ = ':';
+    return writeTwoDigits(out, secondOfDay % 60);
+}
+
+std::string formatTimestamp(int64_t micros, TimestampStyle style) {
+    char buffer[kMaxTimestampChars];
+    return std::string(buffer, formatTimestamp(buffer, buffer + sizeof(buffer), micros, style));
+}
@@ -1,9 +1,8 @@
 #include "Transaction.h"
 #include "OverdraftException.h"
 #include "Account.h"
+#include "Timestamp.h"
 #include <stdexcept>
-#include <iomanip>
-#include <sstream>
 
 Transaction::Transaction(Account* source, Account* destination, const Money& amount)
     : Transaction("", source, destination, amount) {}
@@ -13,53 +12,85 @@ Transaction::Transaction(const std::string& memo, Account* source, Account* dest
     if (source == nullptr && destination == nullptr) {
         throw std::invalid_argument("Both source and destination cannot be null");
     }
-    if (amount.compareTo(Money::fromCents(0)) <= 0) {
+    if (amount <= Money::fromCents(0)) {
         throw std::invalid_argument("Transaction amount should be positive");
     }
     if (source != nullptr && destination != nullptr && source == destination) {
         throw std::invalid_argument("Source and destination accounts cannot be the same");
     }
+    if (source != nullptr && destination != nullptr && source->getLedger() != destination->getLedger()) {
+        throw std::invalid_argument("Source and destination accounts belong to different banks");
+    }
+}
+
+TransactionResult Transaction::tryPerform(bool force) {
+    TransactionResult result;
+    if (source != nullptr && !(result = source->tryAdjust(-amount, force)).ok()) {
+        return result;
+    }
+    if (destination != nullptr && !(result = destination->tryAdjust(amount, force)).ok()) {
+        // Roll back the source adjustment if the destination adjustment fails
+        if (source != nullptr) source->tryAdjust(amount, true);
+        return result;
+    }
+    // The ledger is left as it was on failure; put both balances back to match.
+    auto fail = [&](TransactionStatus status) {
+        if (destination != nullptr) destination->tryAdjust(-amount, true);
+        if (source != nullptr) source->tryAdjust(amount, true);
+        result.status = status;
+        return result;
+    };
+    try {
+        record();
+    } catch (const std::runtime_error&) {
+        return fail(TransactionStatus::StorageFailed);
+    } catch (const std::exception&) {
+        return fail(TransactionStatus::Failed);
+    }
+    return result;
 }
 
 Money Transaction::perform(bool force) {
-    if (source == nullptr) {
-        destination->adjust(amount, force);
-        destination->addTransaction(*this);
-        return amount.negate();
-    } else if (destination == nullptr) {
-        source->adjust(amount.negate(), force);
-        source->addTransaction(*this);
-        return amount;
-    } else {
-        source->adjust(amount.negate(), force);
-        try {
-            destination->adjust(amount, force);
-            source->addTransaction(*this);
-            destination->addTransaction(*this);
-        } catch (const std::exception& e) {
-            // Rollback the source adjustment if destination adjustment fails
-            source->adjust(amount, true);
-            throw;
-        }
-        return Money::fromCents(0);
+    TransactionResult result = tryPerform(force);
+    if (result.status == TransactionStatus::InsufficientFunds) {
+        throw OverdraftException(result.accountId, Money::fromCents(result.shortfallCents));
+    }
+    if (result.status == TransactionStatus::Overflow) {
+        throw std::overflow_error("overflow or underflow");
     }
+    if (!result.ok()) {
+        throw std::runtime_error("Transaction could not be recorded");
+    }
+    if (source == nullptr) return -amount;
+    if (destination == nullptr) return amount;
+    return Money::fromCents(0);
+}
+
+// Appends one row to the accounts' ledger; each account only keeps the row offset.
+void Transaction::record() const {
+    Ledger* ledger = source != nullptr ? source->getLedger() : destination->getLedger();
+    if (ledger == nullptr) {
+        return;
+    }
+    uint32_t row = ledger->append(source != nullptr ? source->getHandle() : Ledger::kNoAccount,
+                                  destination != nullptr ? destination->getHandle() : Ledger::kNoAccount,
+                                  amount.getCents(), getTimestamp(), getType(), memo);
+    if (source != nullptr) source->addPosting(row);
+    if (destination != nullptr) destination->addPosting(row);
 }
 
 std::string Transaction::toString() const {
     std::string result;
     result += (source == nullptr) ? "DEPOSIT" : (destination == nullptr) ? "WITHDRAWAL" : "TRANSFER";
-    if (source != nullptr) result += " from " + source->getID();
-    if (destination != nullptr) result += " to " + destination->getID();
+    if (source != nullptr) result.append(" from ").append(source->getID());
+    if (destination != nullptr) result.append(" to ").append(destination->getID());
     result += ": " + amount.toString();
     if (!memo.empty()) result += " " + memo;
     return result;
 }
 
 std::string Transaction::getDate() const {
-    auto time = std::chrono::system_clock::to_time_t(timestamp);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+    return formatTimestamp(getTimestamp());
 }
 
 Money Transaction::getAmount() const {
@@ -70,4 +101,12 @@ Transaction::Type Transaction::getType() const {
     if (source == nullptr) return Type::DEPOSIT;
     if (destination == nullptr) return Type::WITHDRAWAL;
     return Type::TRANSFER;
+}
+
+const std::string& Transaction::getMemo() const {
+    return memo;
+}
+
+int64_t Transaction::getTimestamp() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+// Compares Bank's hash-indexed findAccount with the linear scan it replaced.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "Bank.h"
+
+namespace {
+
+Account* linearFind(const std::vector<Account*>& accounts, const std::string& accountId) {
+    auto it = std::find_if(accounts.begin(), accounts.end(),
+                           [&accountId](const Account* account) {
+                               return account->getID() == accountId;
+                           });
+    return it != accounts.end() ? *it : nullptr;
+}
+
+template <typename Lookup>
+double nanosPerLookup(const std::vector<std::string>& keys, Lookup lookup) {
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& key : keys) {
+        hits += lookup(key) != nullptr;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (hits != keys.size()) {
+        std::fprintf(stderr, "lookup missed %zu keys\n", keys.size() - hits);
+        std::exit(1);
+    }
+    return std::chrono::duration<double, std::nano>(elapsed).count() / keys.size();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t accountCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    size_t lookupCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+    Bank bank;
+    bank.reserve(accountCount);
+    for (size_t i = 0; i < accountCount; ++i) {
+        std::string id = "2024010112000" + std::to_string(1000000 + i);
+        bank.open("Owner " + std::to_string(i), id, Money::fromCents(0), Money::fromCents(10000),
+                  "user" + std::to_string(i), "user" + std::to_string(i) + "@example.com");
+    }
+
+    std::vector<Account*> accounts = bank.getAccounts();
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> pick(0, accountCount - 1);
+    std::vector<std::string> keys;
+    keys.reserve(lookupCount);
+    for (size_t i = 0; i < lookupCount; ++i) {
+        keys.emplace_back(accounts[pick(gen)]->getID());
+    }
+
+    double scan = nanosPerLookup(keys, [&](const std::string& key) { return linearFind(accounts, key); });
+    double indexed = nanosPerLookup(keys, [&](const std::string& key) { return bank.findAccount(key); });
+
+    std::printf("accounts: %zu, lookups: %zu\n", accountCount, lookupCount);
+    std::printf("linear scan:  %12.1f ns/lookup\n", scan);
+    std::printf("hash index:   %12.1f ns/lookup\n", indexed);
+    std::printf("speedup:      %12.1fx\n", scan / indexed);
+    return 0;
+}
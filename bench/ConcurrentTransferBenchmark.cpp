@@ -0,0 +1,89 @@
+// Runs random transfers through Bank::transferConcurrent on 1..N threads and
+// checks that the sum of all balances never changes. Every transfer still
+// appends its ledger row under Bank's single ledger lock, so the numbers show
+// striped balance updates plus one shared append, not striping alone.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bank.h"
+
+namespace {
+
+int64_t totalBalance(const Bank& bank) {
+    int64_t total = 0;
+    for (const auto& account : bank.getAccounts()) {
+        total += account->getCurrent().getCents();
+    }
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t accountCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t transfersPerThread = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    unsigned maxThreads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::string> ids;
+    ids.reserve(accountCount);
+    for (size_t i = 0; i < accountCount; ++i) {
+        ids.push_back("acct" + std::to_string(100000 + i));
+    }
+
+    // 1, 2, 4, ... and always maxThreads itself, even when it is not a power of two.
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(std::max(1u, maxThreads));
+
+    std::printf("accounts: %zu, transfers/thread: %zu\n", accountCount, transfersPerThread);
+    std::printf("%8s %16s %10s\n", "threads", "transfers/sec", "rejected");
+    for (unsigned threads : threadCounts) {
+        Bank bank;
+        bank.reserve(accountCount);
+        for (const std::string& id : ids) {
+            bank.open("Owner", id, Money::fromCents(0), Money::fromCents(100000));
+        }
+        const int64_t before = totalBalance(bank);
+
+        std::vector<size_t> rejected(threads, 0);
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937 gen(t + 1);
+                std::uniform_int_distribution<size_t> pick(0, accountCount - 1);
+                std::uniform_int_distribution<int64_t> cents(1, 5000);
+                TransactionRequest request;
+                for (size_t i = 0; i < transfersPerThread; ++i) {
+                    size_t from = pick(gen);
+                    size_t to = pick(gen);
+                    if (from == to) to = (to + 1) % accountCount;
+                    request.sourceId = ids[from];
+                    request.destinationId = ids[to];
+                    request.amount = Money::fromCents(cents(gen));
+                    rejected[t] += !bank.transferConcurrent(request).ok();
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (totalBalance(bank) != before) {
+            std::fprintf(stderr, "balance total changed with %u threads\n", threads);
+            return 1;
+        }
+        size_t rejectedTotal = 0;
+        for (size_t r : rejected) rejectedTotal += r;
+        std::printf("%8u %16.0f %10zu\n", threads, threads * transfersPerThread / seconds, rejectedTotal);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Checks the hand-written SHA-256, PBKDF2-HMAC-SHA256 and scrypt against
+// published test vectors (FIPS 180-2 and RFC 7914), and that PasswordHasher
+// rejects a stored hash scrypt could not run. Exits non-zero on any mismatch.
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+#include "PasswordHasher.h"
+#include "Scrypt.h"
+
+namespace {
+
+int failures = 0;
+
+const uint8_t* bytes(const char* text) {
+    return reinterpret_cast<const uint8_t*>(text);
+}
+
+std::string toHex(const uint8_t* data, size_t size) {
+    static const char kHex[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t i = 0; i < size; ++i) {
+        hex += kHex[data[i] >> 4];
+        hex += kHex[data[i] & 15];
+    }
+    return hex;
+}
+
+void expect(const char* name, const uint8_t* actual, size_t size, const char* expected) {
+    const std::string hex = toHex(actual, size);
+    if (hex != expected) {
+        std::printf("FAIL %s\n  got      %s\n  expected %s\n", name, hex.c_str(), expected);
+        ++failures;
+    } else {
+        std::printf("ok   %s\n", name);
+    }
+}
+
+void checkSha256(const char* message, const char* expected) {
+    uint8_t digest[Sha256::kDigestSize];
+    Sha256::hash(bytes(message), std::strlen(message), digest);
+    expect((std::string("sha256 \"") + message + "\"").c_str(), digest, sizeof(digest), expected);
+}
+
+void checkPbkdf2(const char* password, const char* salt, uint32_t iterations, const char* expected) {
+    uint8_t out[64];
+    pbkdf2Sha256(bytes(password), std::strlen(password), bytes(salt), std::strlen(salt), iterations, out,
+                 sizeof(out));
+    expect(("pbkdf2 c=" + std::to_string(iterations)).c_str(), out, sizeof(out), expected);
+}
+
+void checkScrypt(const char* password, const char* salt, uint64_t n, uint32_t r, uint32_t p,
+                 const char* expected) {
+    uint8_t out[64];
+    scrypt(bytes(password), std::strlen(password), bytes(salt), std::strlen(salt), n, r, p, out, sizeof(out));
+    expect(("scrypt N=" + std::to_string(n) + " r=" + std::to_string(r) + " p=" + std::to_string(p)).c_str(),
+           out, sizeof(out), expected);
+}
+
+void checkHasher() {
+    const std::string stored = PasswordHasher::hash("correct horse", {10, 8, 1});
+    const bool roundTrip = PasswordHasher::verify("correct horse", stored)
+                        && !PasswordHasher::verify("wrong horse", stored);
+    // In range for each field, but 4 GiB of scratch together.
+    const std::string tooCostly = "$scrypt$ln=20,r=32,p=1$AAAAAAAAAAAAAAAAAAAAAA$"
+                                  "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA";
+    bool rejected = false;
+    try {
+        rejected = !PasswordHasher::verify("anything", tooCostly);
+    } catch (const std::exception& e) {
+        std::printf("  verify threw: %s\n", e.what());
+    }
+    std::printf("%s password hasher round trip\n", roundTrip ? "ok  " : "FAIL");
+    std::printf("%s password hasher rejects an over-limit hash\n", rejected ? "ok  " : "FAIL");
+    failures += !roundTrip + !rejected;
+}
+
+} // namespace
+
+int main() {
+    checkSha256("", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    checkSha256("abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    checkSha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+                "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // RFC 7914 section 11.
+    checkPbkdf2("passwd", "salt", 1,
+                "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"
+                "49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783");
+    checkPbkdf2("Password", "NaCl", 80000,
+                "4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56"
+                "a1d425a1225833549adb841b51c9b3176a272bdebba1d078478f62b397f33c8d");
+
+    // RFC 7914 section 12.
+    checkScrypt("", "", 16, 1, 1,
+                "77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442"
+                "fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906");
+    checkScrypt("password", "NaCl", 1024, 8, 16,
+                "fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162"
+                "2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640");
+    checkScrypt("pleaseletmein", "SodiumChloride", 16384, 8, 1,
+                "7023bdcb3afd7348461c06cd81fd38ebfda8fbba904f8e3ea9b543f6545da1f2"
+                "d5432955613f0fcf62d49705242a9af9e61e85dc0d651e40dfcf017b45575887");
+
+    checkHasher();
+
+    if (failures != 0) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Formats a column of balances three ways: a std::ostringstream per cell (how
+// Money::toString used to work), formatMoney into a std::string per cell,
+// and MoneyColumn into one arena.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Money.h"
+#include "MoneyFormat.h"
+
+namespace {
+
+template <typename Format>
+double nanosPerCell(size_t cells, int rounds, size_t& bytes, Format format) {
+    bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        bytes += format();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (double(cells) * rounds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::mt19937_64 gen(3);
+    std::uniform_int_distribution<int64_t> cents(-10000000, 100000000);
+    std::vector<Money> balances;
+    balances.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        balances.push_back(Money::fromCents(cents(gen)));
+    }
+
+    size_t streamBytes = 0;
+    size_t stringBytes = 0;
+    size_t columnBytes = 0;
+    std::vector<std::string> cells;
+    double stream = nanosPerCell(rows, rounds, streamBytes, [&]() {
+        cells.clear();
+        size_t bytes = 0;
+        for (const Money& balance : balances) {
+            const int64_t value = balance.getCents();
+            const uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+            std::ostringstream out;
+            out << (value < 0 ? "-" : "") << magnitude / 100 << '.' << std::setw(2) << std::setfill('0')
+                << magnitude % 100;
+            cells.push_back(out.str());
+            bytes += cells.back().size();
+        }
+        return bytes;
+    });
+    double string = nanosPerCell(rows, rounds, stringBytes, [&]() {
+        cells.clear();
+        size_t bytes = 0;
+        for (const Money& balance : balances) {
+            char text[kMaxMoneyChars];
+            char* end = formatMoney(text, text + sizeof(text), balance.getCents(), MoneyStyle::Plain);
+            cells.emplace_back(text, end);
+            bytes += cells.back().size();
+        }
+        return bytes;
+    });
+    MoneyColumn column;
+    double arena = nanosPerCell(rows, rounds, columnBytes, [&]() {
+        column.assign(balances.begin(), balances.end());
+        size_t bytes = 0;
+        for (size_t i = 0; i < column.size(); ++i) {
+            bytes += column[i].size();
+        }
+        return bytes;
+    });
+
+    if (streamBytes != stringBytes || stringBytes != columnBytes) {
+        std::fprintf(stderr, "formatted lengths differ: %zu, %zu, %zu\n", streamBytes, stringBytes, columnBytes);
+        return 1;
+    }
+    std::printf("rows: %zu, rounds: %d\n", rows, rounds);
+    std::printf("ostringstream per cell: %8.1f ns/cell\n", stream);
+    std::printf("formatMoney per cell:   %8.1f ns/cell\n", string);
+    std::printf("MoneyColumn:            %8.1f ns/cell\n", arena);
+    // Short cells fit std::string's inline buffer, so the per-cell cost is
+    // mostly the string objects themselves.
+    std::printf("held as std::string:    %8zu bytes\n", rows * sizeof(std::string));
+    std::printf("held by MoneyColumn:    %8zu bytes\n", columnBytes / rounds + (rows + 1) * sizeof(uint32_t));
+    return 0;
+}
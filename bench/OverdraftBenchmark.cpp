@@ -0,0 +1,67 @@
+// Rejection-heavy workload: most debits overdraw their account. Compares the
+// throwing Account::adjust with Account::tryAdjust.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "Account.h"
+#include "OverdraftException.h"
+
+namespace {
+
+template <typename Adjust>
+double nanosPerAttempt(const std::vector<Money>& amounts, size_t& rejected, Adjust adjust) {
+    StringPool strings;
+    Account account(strings, "Owner", "acct0001", Money::fromCents(0), Money::fromCents(1000));
+    rejected = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Money& amount : amounts) {
+        rejected += !adjust(account, amount);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / amounts.size();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t attempts = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    double rejectShare = argc > 2 ? std::atof(argv[2]) : 0.9;
+
+    // Debits large enough to overdraw with probability rejectShare; every
+    // accepted debit is paired with a deposit so the balance stays put.
+    std::mt19937 gen(7);
+    std::bernoulli_distribution reject(rejectShare);
+    std::vector<Money> amounts;
+    amounts.reserve(attempts);
+    for (size_t i = 0; i < attempts; ++i) {
+        bool overdraw = reject(gen);
+        amounts.push_back(Money::fromCents(overdraw ? -5000 : -10));
+        if (!overdraw) amounts.push_back(Money::fromCents(10));
+    }
+
+    size_t thrown = 0;
+    size_t returned = 0;
+    double throwing = nanosPerAttempt(amounts, thrown, [](Account& account, const Money& amount) {
+        try {
+            account.adjust(amount);
+            return true;
+        } catch (const OverdraftException&) {
+            return false;
+        }
+    });
+    double result = nanosPerAttempt(amounts, returned, [](Account& account, const Money& amount) {
+        return account.tryAdjust(amount).ok();
+    });
+
+    if (thrown != returned) {
+        std::fprintf(stderr, "rejection counts differ: %zu vs %zu\n", thrown, returned);
+        return 1;
+    }
+    std::printf("attempts: %zu, rejected: %zu\n", amounts.size(), returned);
+    std::printf("adjust (throws):    %8.1f ns/attempt\n", throwing);
+    std::printf("tryAdjust (result): %8.1f ns/attempt\n", result);
+    std::printf("speedup:            %8.1fx\n", throwing / result);
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Sizes the password KDF cost: times PasswordHasher at increasing scrypt N
+// and recommends the largest cost that keeps one login under a latency
+// budget while the worker pool still sustains the expected login rate.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "PasswordHasher.h"
+
+namespace {
+
+double millisPerHash(PasswordHasher::Params params, int samples) {
+    std::vector<double> times;
+    for (int i = 0; i < samples; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        PasswordHasher::hash("correct horse battery staple", params);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// Hashes per second with every pool thread busy; memory bandwidth, not the
+// core count, is usually what limits this.
+double hashesPerSecond(PasswordHasher::Params params, unsigned threads, int perThread) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([params, perThread] {
+            for (int i = 0; i < perThread; ++i) {
+                PasswordHasher::hash("correct horse battery staple", params);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threads * perThread / seconds;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double budgetMs = argc > 1 ? std::atof(argv[1]) : 250.0;
+    double loginsPerSecond = argc > 2 ? std::atof(argv[2]) : 5.0;
+    unsigned threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("latency budget: %.0f ms, login rate: %.1f/s, pool threads: %u\n", budgetMs, loginsPerSecond, threads);
+    std::printf("%4s %4s %4s %10s %12s %12s\n", "ln", "r", "p", "memory", "ms/login", "logins/s");
+
+    const PasswordHasher::Params current = PasswordHasher::Params::interactive();
+    std::optional<PasswordHasher::Params> recommended;
+    for (uint32_t log2N = 10; log2N <= 20; ++log2N) {
+        PasswordHasher::Params params{log2N, current.r, current.p};
+        double ms = millisPerHash(params, 3);
+        double rate = hashesPerSecond(params, threads, 2);
+        std::printf("%4u %4u %4u %7zu MiB %12.1f %12.1f%s\n", params.log2N, params.r, params.p,
+                    params.memoryBytes() >> 20, ms, rate, log2N == current.log2N ? "   (current)" : "");
+        if (ms <= budgetMs && rate >= loginsPerSecond) {
+            recommended = params;
+        }
+        if (ms > 4 * budgetMs) {
+            break;
+        }
+    }
+
+    if (recommended) {
+        std::printf("recommended: ln=%u,r=%u,p=%u\n", recommended->log2N, recommended->r, recommended->p);
+    } else {
+        std::printf("no cost in range meets the budget; lower r or raise the budget\n");
+    }
+    return 0;
+}
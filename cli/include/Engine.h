@@ -0,0 +1,64 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <QString>
+#include <memory>
+#include <optional>
+#include "Bank.h"
+#include "FinanceDatabase.h"
+#include "GroupCommitter.h"
+
+// What a command-line workload runs against: either the SQL data layer (as
+// the GUI uses it) or the in-memory Bank engine alone. Transfers may complete
+// later than they are submitted (group commit); finish() waits for all of
+// them, after which the counters are final.
+class Engine {
+public:
+    virtual ~Engine() = default;
+
+    virtual bool open(const QString &id, const QString &username, const QString &owner, const Money &balance) = 0;
+    virtual void transfer(const QString &sourceId, const QString &destinationId, const Money &amount) = 0;
+    virtual std::optional<Money> balance(const QString &id) = 0;
+    virtual void finish() {}
+
+    long long transfersOk() const { return ok; }
+    long long transfersRejected() const { return rejected; }
+
+protected:
+    long long ok = 0;
+    long long rejected = 0;
+};
+
+class SqlEngine : public Engine {
+public:
+    // groupCommitMs <= 0 commits every transfer on its own.
+    SqlEngine(FinanceDatabase *database, int groupCommitMs);
+
+    bool open(const QString &id, const QString &username, const QString &owner, const Money &balance) override;
+    void transfer(const QString &sourceId, const QString &destinationId, const Money &amount) override;
+    std::optional<Money> balance(const QString &id) override;
+    void finish() override;
+
+private:
+    FinanceDatabase *database;
+    std::unique_ptr<GroupCommitter> committer;
+
+    void count(FinanceDatabase::TransferStatus status);
+};
+
+class BankEngine : public Engine {
+public:
+    // storage, if given, is replayed into the bank and records what follows.
+    explicit BankEngine(Storage *storage = nullptr);
+
+    bool open(const QString &id, const QString &username, const QString &owner, const Money &balance) override;
+    void transfer(const QString &sourceId, const QString &destinationId, const Money &amount) override;
+    std::optional<Money> balance(const QString &id) override;
+    void finish() override;
+
+private:
+    Bank bank;
+    Storage *storage;
+};
+
+#endif // ENGINE_H
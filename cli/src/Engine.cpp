@@ -0,0 +1,103 @@
+#include "Engine.h"
+#include "PasswordHasher.h"
+#include <QCoreApplication>
+#include <cstdio>
+#include <stdexcept>
+
+SqlEngine::SqlEngine(FinanceDatabase *database, int groupCommitMs) : database(database) {
+    if (groupCommitMs > 0) {
+        committer = std::make_unique<GroupCommitter>(database, groupCommitMs);
+    }
+}
+
+bool SqlEngine::open(const QString &id, const QString &username, const QString &owner, const Money &balance) {
+    if (database->accountExists(id)) {
+        return false;
+    }
+    FinanceDatabase::AccountRecord record;
+    record.id = id;
+    record.username = username;
+    record.owner = owner;
+    // Hashing a password per open would swamp the timings, so load-test
+    // accounts get a disabled credential and cannot log in.
+    record.password = QString::fromUtf8(PasswordHasher::kDisabled.data(), int(PasswordHasher::kDisabled.size()));
+    record.balance = balance;
+    return database->insertAccount(record);
+}
+
+void SqlEngine::transfer(const QString &sourceId, const QString &destinationId, const Money &amount) {
+    if (!committer) {
+        count(database->transfer(sourceId, destinationId, amount));
+        return;
+    }
+    committer->submit(sourceId, destinationId, amount,
+                      [this](FinanceDatabase::TransferStatus status) { count(status); });
+    // There is no long-running event loop here; let the window timer fire.
+    QCoreApplication::processEvents();
+}
+
+std::optional<Money> SqlEngine::balance(const QString &id) {
+    if (committer) {
+        committer->flush();
+    }
+    return database->balance(id);
+}
+
+void SqlEngine::finish() {
+    if (committer) {
+        committer->flush();
+    }
+}
+
+void SqlEngine::count(FinanceDatabase::TransferStatus status) {
+    if (status == FinanceDatabase::TransferStatus::Ok) {
+        ++ok;
+    } else {
+        ++rejected;
+    }
+}
+
+BankEngine::BankEngine(Storage *storage) : storage(storage) {
+    bank.attachStorage(storage);
+}
+
+bool BankEngine::open(const QString &id, const QString &username, const QString &owner, const Money &balance) {
+    try {
+        bank.open(owner.toStdString(), id.toStdString(), Money::fromCents(0), balance, username.toStdString(), "");
+    } catch (const std::invalid_argument&) {
+        return false;
+    } catch (const std::runtime_error&) {
+        // The journal could not record it, so the bank did not open it.
+        return false;
+    }
+    return true;
+}
+
+void BankEngine::transfer(const QString &sourceId, const QString &destinationId, const Money &amount) {
+    const std::string source = sourceId.toStdString();
+    const std::string destination = destinationId.toStdString();
+    TransactionRequest request{source, destination, amount, "TRANSFER"};
+    if (bank.transfer(request).ok()) {
+        ++ok;
+    } else {
+        ++rejected;
+    }
+}
+
+std::optional<Money> BankEngine::balance(const QString &id) {
+    const Account* account = bank.findAccount(id.toStdString());
+    if (!account) {
+        return std::nullopt;
+    }
+    return account->getCurrent();
+}
+
+void BankEngine::finish() {
+    if (storage) {
+        try {
+            storage->sync();
+        } catch (const std::runtime_error &e) {
+            std::fprintf(stderr, "%s\n", e.what());
+        }
+    }
+}
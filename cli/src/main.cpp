@@ -0,0 +1,331 @@
+// Headless driver for the Bank engine and the SQL layer: opens accounts,
+// posts transfers and replays workload files, then prints timing summaries.
+// Needs neither a display nor the Widgets module.
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <vector>
+#include "ConnectionProfile.h"
+#include "Engine.h"
+#include "FinanceDatabase.h"
+#include "IdGenerator.h"
+#include "JournalStorage.h"
+#include "SchemaMigrator.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Latencies of one command kind, in nanoseconds.
+struct Timings {
+    std::vector<long long> samples;
+
+    void print(const char *name) {
+        if (samples.empty()) {
+            return;
+        }
+        std::sort(samples.begin(), samples.end());
+        long long total = 0;
+        for (long long sample : samples) {
+            total += sample;
+        }
+        auto percentile = [this](double p) {
+            return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))] / 1000.0;
+        };
+        std::printf("%-9s %10zu ops %10.1f ms %12.0f ops/s   p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+                    name, samples.size(), total / 1e6, samples.size() * 1e9 / std::max(total, 1LL),
+                    percentile(0.50), percentile(0.99), samples.back() / 1000.0);
+    }
+};
+
+std::optional<Money> parseAmount(const QString &text) {
+    // Exact decimal parsing: "12.3" is 1230 cents, never 1229.
+    const QStringList parts = text.split('.');
+    bool ok = parts.size() <= 2 && !parts[0].isEmpty();
+    const long long dollars = ok ? parts[0].toLongLong(&ok) : 0;
+    if (!ok || dollars < 0) {
+        return std::nullopt;
+    }
+    long long cents = 0;
+    if (parts.size() == 2) {
+        const QString fraction = parts[1];
+        if (fraction.isEmpty() || fraction.size() > 2) {
+            return std::nullopt;
+        }
+        cents = fraction.toLongLong(&ok) * (fraction.size() == 1 ? 10 : 1);
+        if (!ok) {
+            return std::nullopt;
+        }
+    }
+    if (dollars > (INT64_MAX - cents) / 100) {
+        return std::nullopt;
+    }
+    return Money::fromCents(dollars * 100 + cents);
+}
+
+class Runner {
+public:
+    Runner(Engine &engine, uint32_t node) : engine(engine), accountIds(node) {}
+
+    // Runs one command; returns false and reports on stderr if it is invalid.
+    bool run(const QStringList &args, const QString &where) {
+        const QString command = args.value(0);
+        if (command == "open" && args.size() == 5) {
+            std::optional<Money> balance = parseAmount(args[4]);
+            if (!balance) {
+                return fail(where, "invalid amount " + args[4]);
+            }
+            // "-" asks for a generated id, which is printed.
+            const bool generated = args[1] == "-";
+            const QString id = generated ? QString::fromStdString(IdGenerator::format(accountIds.next())) : args[1];
+            auto start = Clock::now();
+            bool opened = engine.open(id, args[2], args[3], *balance);
+            record(opens, start);
+            if (!opened) {
+                return fail(where, "could not open account " + id);
+            }
+            if (generated && !quiet) {
+                std::printf("%s\n", qPrintable(id));
+            }
+            return true;
+        }
+        if (command == "transfer" && args.size() == 4) {
+            std::optional<Money> amount = parseAmount(args[3]);
+            if (!amount) {
+                return fail(where, "invalid amount " + args[3]);
+            }
+            auto start = Clock::now();
+            engine.transfer(args[1], args[2], *amount);
+            record(transfers, start);
+            return true;
+        }
+        if (command == "balance" && args.size() == 2) {
+            auto start = Clock::now();
+            std::optional<Money> balance = engine.balance(args[1]);
+            record(balances, start);
+            if (!balance) {
+                return fail(where, "unknown account " + args[1]);
+            }
+            if (!quiet) {
+                std::printf("%s %s\n", qPrintable(args[1]), balance->toString().c_str());
+            }
+            return true;
+        }
+        return fail(where, "unrecognized command: " + args.join(' '));
+    }
+
+    // One command per line; blank lines and lines starting with '#' are skipped.
+    bool replay(const QString &path) {
+        QFile file(path);
+        if (!file.open(QFile::ReadOnly | QFile::Text)) {
+            return fail(path, file.errorString());
+        }
+        QTextStream in(&file);
+        bool clean = true;
+        for (int line = 1; !in.atEnd(); ++line) {
+            const QString text = in.readLine().trimmed();
+            if (text.isEmpty() || text.startsWith('#')) {
+                continue;
+            }
+            clean &= run(text.split(' ', Qt::SkipEmptyParts), path + ":" + QString::number(line));
+        }
+        return clean;
+    }
+
+    void summarize() {
+        auto start = Clock::now();
+        engine.finish();
+        if (!transfers.samples.empty()) {
+            // Group commit defers the last batch's commit to here.
+            transfers.samples.back() += nanosSince(start);
+        }
+        opens.print("open");
+        transfers.print("transfer");
+        balances.print("balance");
+        if (!transfers.samples.empty()) {
+            std::printf("transfers: %lld ok, %lld rejected\n", engine.transfersOk(), engine.transfersRejected());
+        }
+    }
+
+    bool quiet = false;
+
+private:
+    Engine &engine;
+    IdGenerator accountIds;
+    Timings opens;
+    Timings transfers;
+    Timings balances;
+
+    static long long nanosSince(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    static void record(Timings &timings, Clock::time_point start) {
+        timings.samples.push_back(nanosSince(start));
+    }
+
+    static bool fail(const QString &where, const QString &message) {
+        std::fprintf(stderr, "%s: %s\n", qPrintable(where), qPrintable(message));
+        return false;
+    }
+};
+
+bool openDatabase(const QString &path, ConnectionProfile profile) {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(path);
+    if (!db.open()) {
+        std::fprintf(stderr, "cannot open %s: %s\n", qPrintable(path), qPrintable(db.lastError().text()));
+        return false;
+    }
+    QString error;
+    if (!applyConnectionProfile(db, profile, &error)) {
+        std::fprintf(stderr, "cannot apply profile %s: %s\n", qPrintable(connectionProfileName(profile)),
+                     qPrintable(error));
+        return false;
+    }
+    SchemaMigrator migrator(db);
+    if (!migrator.migrate()) {
+        std::fprintf(stderr, "schema migration failed: %s\n", qPrintable(migrator.lastError()));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("FamilyFinancesCli");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Runs Family Finances workloads without a display.\n\n"
+        "Commands (also the line format of replay files):\n"
+        "  open <id> <username> <owner> <balance>   (id - generates one)\n"
+        "  transfer <from-id> <to-id> <amount>\n"
+        "  balance <id>\n"
+        "  replay <file>\n"
+        "  check-plans      list SQL statements that scan a table; exits 1 if any do");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption dbOption("db", "SQLite database file.", "path");
+    QCommandLineOption memoryOption("memory", "Use a fresh in-memory SQLite database.");
+    QCommandLineOption profileOption("profile", "Connection profile: safe, wal or bulk.", "profile", "wal");
+    QCommandLineOption engineOption("engine", "sql (default) or bank for the in-memory engine alone.", "engine", "sql");
+    QCommandLineOption groupCommitOption("group-commit", "Batch transfers arriving within <ms> into one commit.",
+                                         "ms", "0");
+    QCommandLineOption journalOption("journal", "With --engine bank: replay and append to this journal file.", "path");
+    QCommandLineOption syncEveryOption("sync-every", "Journal records per fsync; 0 syncs only at exit.", "n", "1");
+    QCommandLineOption nodeOption("node", "Id generator node for generated account ids (0-1023); "
+                                  "by default leased from the database.", "n");
+    QCommandLineOption quietOption({"q", "quiet"}, "Only print the timing summary.");
+    parser.addOptions({dbOption, memoryOption, profileOption, engineOption, groupCommitOption, journalOption,
+                       syncEveryOption, nodeOption, quietOption});
+    parser.addPositionalArgument("command", "Command to run, followed by its arguments.", "<command> [args...]");
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const QString engineName = parser.value(engineOption);
+    if (engineName != "sql" && engineName != "bank") {
+        std::fprintf(stderr, "unknown engine %s\n", qPrintable(engineName));
+        return 1;
+    }
+
+    std::unique_ptr<FinanceDatabase> database;
+    std::unique_ptr<Storage> journal;
+    std::unique_ptr<Engine> engine;
+    if (engineName == "sql") {
+        if (parser.isSet(dbOption) == parser.isSet(memoryOption)) {
+            std::fprintf(stderr, "give exactly one of --db <path> or --memory\n");
+            return 1;
+        }
+        std::optional<ConnectionProfile> profile = connectionProfileFromName(parser.value(profileOption));
+        if (!profile) {
+            std::fprintf(stderr, "unknown profile %s\n", qPrintable(parser.value(profileOption)));
+            return 1;
+        }
+        if (!openDatabase(parser.isSet(memoryOption) ? ":memory:" : parser.value(dbOption), *profile)) {
+            return 1;
+        }
+        database = std::make_unique<FinanceDatabase>();
+        engine = std::make_unique<SqlEngine>(database.get(), parser.value(groupCommitOption).toInt());
+    } else {
+        try {
+            if (parser.isSet(journalOption)) {
+                JournalStorage::Options options;
+                options.syncEvery = parser.value(syncEveryOption).toULongLong();
+                journal = std::make_unique<JournalStorage>(parser.value(journalOption).toStdString(), options);
+            }
+            auto start = Clock::now();
+            engine = std::make_unique<BankEngine>(journal.get());
+            if (journal) {
+                std::printf("journal replayed in %.1f ms\n",
+                            std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+        } catch (const std::exception &e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    }
+
+    bool ok = true;
+    if (args[0] == "check-plans") {
+        if (!database) {
+            std::fprintf(stderr, "check-plans needs the sql engine\n");
+            return 1;
+        }
+        // The regression guard for the statement indexes: a non-zero exit
+        // fails whatever script runs it.
+        const QStringList scans = database->tableScans();
+        for (const QString &scan : scans) {
+            std::printf("%s\n", qPrintable(scan));
+        }
+        if (!scans.isEmpty()) {
+            std::fprintf(stderr, "%lld statement(s) fall back to a table scan\n", static_cast<long long>(scans.size()));
+        }
+        ok = scans.isEmpty();
+    } else {
+        std::optional<uint32_t> node;
+        if (parser.isSet(nodeOption)) {
+            bool valid = false;
+            const uint32_t value = parser.value(nodeOption).toUInt(&valid);
+            if (!valid || value > IdGenerator::kMaxNode) {
+                std::fprintf(stderr, "--node must be between 0 and %u\n", IdGenerator::kMaxNode);
+                return 1;
+            }
+            node = value;
+        } else if (database) {
+            node = database->leaseIdNode();
+        }
+        Runner runner(*engine, node.value_or(IdGenerator::defaultNode()));
+        runner.quiet = parser.isSet(quietOption);
+        if (args[0] == "replay" && args.size() == 2) {
+            ok = runner.replay(args[1]);
+        } else {
+            ok = runner.run(args, "command line");
+        }
+        runner.summarize();
+    }
+
+    // Runner::summarize() called finish(), so nothing is left queued for the
+    // database; the engine still goes first since it holds a pointer to it.
+    engine.reset();
+    journal.reset();
+    database.reset();
+    QSqlDatabase::database().close();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+#ifndef CONNECTIONPROFILE_H
+#define CONNECTIONPROFILE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <optional>
+
+// Durability/throughput trade-offs for a SQLite connection. Apply one right
+// after QSqlDatabase::open() and before the first transaction.
+//
+//   Safe        rollback journal, synchronous=FULL: every commit is fsynced.
+//   WalNormal   WAL with synchronous=NORMAL: commits are durable once the WAL
+//               is checkpointed; a power loss can drop the last few commits
+//               but never corrupts the file. Readers don't block the writer.
+//   BulkImport  in-memory journal, synchronous=OFF: for one-off loads into a
+//               file that can be rebuilt if the machine crashes mid-import.
+enum class ConnectionProfile { Safe, WalNormal, BulkImport };
+
+bool applyConnectionProfile(QSqlDatabase &db, ConnectionProfile profile, QString *error = nullptr);
+
+// Names are "safe", "wal" and "bulk", as accepted on the command line.
+QString connectionProfileName(ConnectionProfile profile);
+std::optional<ConnectionProfile> connectionProfileFromName(const QString &name);
+
+#endif // CONNECTIONPROFILE_H
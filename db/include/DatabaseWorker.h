@@ -0,0 +1,64 @@
+#ifndef DATABASEWORKER_H
+#define DATABASEWORKER_H
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QString>
+#include <QThread>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include "ConnectionProfile.h"
+#include "FinanceDatabase.h"
+
+// Runs database work on a dedicated thread that owns its own named
+// connection to the same SQLite file, so statements and commits never block
+// the GUI thread. Tasks run one at a time in submission order; each gets the
+// worker's FinanceDatabase and its result comes back through a QFuture.
+// Handle results on the GUI thread with QFuture::then(widget, ...), which
+// also drops them if the widget is gone by then. An exception thrown by a
+// task fails its future, so pair then() with onFailed().
+class DatabaseWorker : public QObject {
+    Q_OBJECT
+
+public:
+    DatabaseWorker(const QString &databaseName, ConnectionProfile profile, QObject *parent = nullptr);
+    // Finishes the queued tasks, then closes the connection.
+    ~DatabaseWorker() override;
+
+    DatabaseWorker(const DatabaseWorker&) = delete;
+    DatabaseWorker& operator=(const DatabaseWorker&) = delete;
+
+    template <typename Task>
+    QFuture<std::invoke_result_t<Task, FinanceDatabase&>> run(Task task) {
+        using Result = std::invoke_result_t<Task, FinanceDatabase&>;
+        // Shared because queued functors must be copyable; QPromise is not.
+        auto promise = std::make_shared<QPromise<Result>>();
+        QFuture<Result> future = promise->future();
+        promise->start();
+        QMetaObject::invokeMethod(context, [this, promise, task]() mutable {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    task(*database);
+                } else {
+                    promise->addResult(task(*database));
+                }
+            } catch (...) {
+                promise->setException(std::current_exception());
+            }
+            promise->finish();
+        }, Qt::QueuedConnection);
+        return future;
+    }
+
+private:
+    QThread thread;
+    // Lives on the worker thread; queued tasks run in its context.
+    QObject *context;
+    QString connectionName;
+    // Created, used and destroyed on the worker thread only.
+    std::unique_ptr<FinanceDatabase> database;
+};
+
+#endif // DATABASEWORKER_H
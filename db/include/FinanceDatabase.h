@@ -0,0 +1,154 @@
+#ifndef FINANCEDATABASE_H
+#define FINANCEDATABASE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <array>
+#include <memory>
+#include <optional>
+#include "Money.h"
+
+// Data-access layer over one QSqlDatabase connection. Every statement the
+// application runs is named here and prepared once per connection; callers
+// use the typed methods instead of writing SQL inline. Destroy it before
+// its connection is closed or removed.
+class FinanceDatabase {
+public:
+    struct AccountRecord {
+        QString id;
+        QString username;
+        QString owner;
+        QString email;
+        QString password;
+        Money balance = Money::fromCents(0);
+        bool isAdmin = false;
+    };
+
+    struct LoginRecord {
+        QString accountId;
+        QString owner;
+        // A PasswordHasher hash, or a legacy plaintext password until its
+        // owner next logs in.
+        QString credential;
+        bool isAdmin = false;
+    };
+
+    struct PostingRecord {
+        QString date;
+        QString type;
+        Money amount = Money::fromCents(0);
+    };
+
+    struct BalanceRecord {
+        QString accountId;
+        Money balance = Money::fromCents(0);
+    };
+
+    enum class TransferStatus {
+        Ok,
+        InvalidAmount,   // zero or negative
+        SameAccount,
+        UnknownSource,
+        UnknownDestination,
+        InsufficientFunds,
+        Failed,
+    };
+
+    struct TransferRecord {
+        QString sourceId;
+        QString destinationId;
+        Money amount = Money::fromCents(0);
+    };
+
+    explicit FinanceDatabase(const QString &connectionName = QLatin1String(QSqlDatabase::defaultConnection));
+    ~FinanceDatabase();
+
+    FinanceDatabase(const FinanceDatabase&) = delete;
+    FinanceDatabase& operator=(const FinanceDatabase&) = delete;
+
+    QSqlDatabase database() const;
+    QString lastError() const;
+
+    // Runs EXPLAIN QUERY PLAN over the hot statements and returns the ones
+    // SQLite would answer with a table scan or a temporary sort.
+    QStringList tableScans();
+
+    std::optional<Money> balance(const QString &accountId);
+    bool accountExists(const QString &accountId);
+    std::optional<AccountRecord> account(const QString &accountId);
+    QVector<AccountRecord> accounts();
+    QVector<PostingRecord> recentPostings(const QString &accountId, int limit);
+    // Fails, rather than overwriting, if the id, username or email is taken.
+    bool insertAccount(const AccountRecord &account);
+
+    // A node for this process's IdGenerator. Each call takes the next of
+    // IdGenerator::kMaxNode + 1 nodes in turn, so processes sharing the
+    // database get distinct nodes unless over a thousand others started
+    // in between.
+    std::optional<uint32_t> leaseIdNode();
+
+    // Position in the account change log; accounts changed after a given
+    // position are re-read with accountsChangedSince(). pruneChanges() drops
+    // entries before a position nobody needs any more; the entry at it is
+    // kept so changeSequence() never moves backwards.
+    qint64 changeSequence();
+    QVector<AccountRecord> accountsChangedSince(qint64 sequence);
+    bool pruneChanges(qint64 upTo);
+
+    // Everything a login needs, in one indexed lookup by username.
+    std::optional<LoginRecord> login(const QString &username);
+    bool setPassword(const QString &username, const QString &passwordHash);
+
+    // Debits the source, credits the destination and records both postings
+    // in one SQL transaction.
+    TransferStatus transfer(const QString &sourceId, const QString &destinationId, const Money &amount);
+
+    // Runs every transfer in one SQL transaction, each inside its own
+    // savepoint so a failed transfer is undone without affecting the rest.
+    // One commit (and one fsync) covers the whole batch; if that commit
+    // fails, every result is Failed.
+    QVector<TransferStatus> transferBatch(const QVector<TransferRecord> &transfers);
+
+private:
+    enum class Statement {
+        SelectBalance,
+        SelectAccountExists,
+        SelectAccount,
+        SelectAllAccounts,
+        SelectRecentPostings,
+        InsertAccount,
+        SelectLogin,
+        Debit,
+        Credit,
+        InsertPosting,
+        Savepoint,
+        ReleaseSavepoint,
+        RollbackToSavepoint,
+        SelectChangeSequence,
+        SelectAccountsChangedSince,
+        PruneChanges,
+        UpdatePassword,
+        InsertIdNodeLease,
+        PruneIdNodeLeases,
+        Count
+    };
+
+    QString connectionName;
+    std::array<std::unique_ptr<QSqlQuery>, static_cast<size_t>(Statement::Count)> statements;
+    // False until a statement's prepare succeeds, so a failed one is retried.
+    std::array<bool, static_cast<size_t>(Statement::Count)> statementReady{};
+    QString error;
+
+    // The query object for a statement lives as long as the connection, so
+    // callers may hold several references at once.
+    QSqlQuery& prepared(Statement statement);
+    bool exec(QSqlQuery &query);
+    static AccountRecord readAccount(const QSqlQuery &query);
+    TransferStatus applyTransfer(const QString &sourceId, const QString &destinationId, const Money &amount,
+                                 const QString &date);
+};
+
+#endif // FINANCEDATABASE_H
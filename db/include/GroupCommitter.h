@@ -0,0 +1,47 @@
+#ifndef GROUPCOMMITTER_H
+#define GROUPCOMMITTER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+#include "FinanceDatabase.h"
+
+// Collects transfers submitted within a short window and commits them as one
+// FinanceDatabase::transferBatch(), so a burst of N transfers costs one fsync
+// instead of N. Lives on the thread that owns the database connection;
+// completion callbacks run there after the batch commits.
+//
+// The database is not owned. Call flush() while it is still open and before
+// destroying the committer: the destructor does not touch the database, and
+// transfers still queued then are dropped without their callbacks running.
+class GroupCommitter : public QObject {
+    Q_OBJECT
+
+public:
+    using Completion = std::function<void(FinanceDatabase::TransferStatus)>;
+
+    explicit GroupCommitter(FinanceDatabase *database, int windowMs = 5, int maxBatch = 512,
+                            QObject *parent = nullptr);
+    ~GroupCommitter() override;
+
+    void submit(const QString &sourceId, const QString &destinationId, const Money &amount,
+                Completion done = nullptr);
+    int pending() const;
+
+public slots:
+    // Commits whatever is queued now instead of waiting for the window.
+    void flush();
+
+signals:
+    void batchCommitted(int transfers);
+
+private:
+    FinanceDatabase *database;
+    int maxBatch;
+    QTimer timer;
+    QVector<FinanceDatabase::TransferRecord> queued;
+    QVector<Completion> completions;
+};
+
+#endif // GROUPCOMMITTER_H
@@ -0,0 +1,34 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+// Brings a database up to the current schema. The applied version is kept in
+// SQLite's PRAGMA user_version; each pending step runs in its own transaction
+// together with the version bump, so a failed step leaves the database at the
+// previous version.
+class SchemaMigrator {
+public:
+    explicit SchemaMigrator(const QSqlDatabase &db);
+
+    static int latestVersion();
+    int version() const;
+    bool migrate();
+    QString lastError() const;
+
+private:
+    QSqlDatabase db;
+    QString error;
+
+    bool hasColumn(const QString &table, const QString &column) const;
+    bool createBaseSchema();
+    bool convertToIntegerCents();
+    bool createHotQueryIndexes();
+    bool createAccountChangeLog();
+    bool narrowAccountChangeTrigger();
+    bool createIdNodeLeases();
+    bool exec(const QString &statement);
+};
+
+#endif // SCHEMAMIGRATOR_H
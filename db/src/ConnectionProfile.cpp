@@ -0,0 +1,71 @@
+#include "ConnectionProfile.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+
+namespace {
+
+struct ProfileSettings {
+    const char *name;
+    const char *journalMode;
+    const char *synchronous;
+    qint64 mmapSize;
+    int cacheSizeKiB;
+    int busyTimeoutMs;
+};
+
+// Indexed by ConnectionProfile.
+const ProfileSettings kProfiles[] = {
+    {"safe", "DELETE", "FULL", 0, 2000, 5000},
+    {"wal", "WAL", "NORMAL", 256LL * 1024 * 1024, 16 * 1024, 5000},
+    {"bulk", "MEMORY", "OFF", 256LL * 1024 * 1024, 64 * 1024, 30000},
+};
+
+}
+
+bool applyConnectionProfile(QSqlDatabase &db, ConnectionProfile profile, QString *error) {
+    const ProfileSettings &settings = kProfiles[static_cast<size_t>(profile)];
+    // A negative cache_size is in KiB rather than pages.
+    const QString pragmas[] = {
+        QString("PRAGMA journal_mode = %1").arg(settings.journalMode),
+        QString("PRAGMA synchronous = %1").arg(settings.synchronous),
+        QString("PRAGMA mmap_size = %1").arg(settings.mmapSize),
+        QString("PRAGMA cache_size = -%1").arg(settings.cacheSizeKiB),
+        QString("PRAGMA busy_timeout = %1").arg(settings.busyTimeoutMs),
+        QString("PRAGMA temp_store = MEMORY"),
+    };
+
+    QSqlQuery query(db);
+    for (const QString &pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            if (error) {
+                *error = query.lastError().text();
+            }
+            qDebug() << "Error applying" << pragma << "-" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // journal_mode answers with the mode actually in effect; in-memory
+    // databases, for one, cannot switch to WAL.
+    if (query.exec("PRAGMA journal_mode") && query.next()) {
+        const QString mode = query.value(0).toString();
+        if (mode.compare(QLatin1String(settings.journalMode), Qt::CaseInsensitive) != 0) {
+            qDebug() << "SQLite kept journal_mode" << mode << "instead of" << settings.journalMode;
+        }
+    }
+    return true;
+}
+
+QString connectionProfileName(ConnectionProfile profile) {
+    return QString::fromLatin1(kProfiles[static_cast<size_t>(profile)].name);
+}
+
+std::optional<ConnectionProfile> connectionProfileFromName(const QString &name) {
+    for (size_t i = 0; i < sizeof(kProfiles) / sizeof(kProfiles[0]); ++i) {
+        if (name.compare(QLatin1String(kProfiles[i].name), Qt::CaseInsensitive) == 0) {
+            return static_cast<ConnectionProfile>(i);
+        }
+    }
+    return std::nullopt;
+}
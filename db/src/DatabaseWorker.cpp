@@ -0,0 +1,38 @@
+#include "DatabaseWorker.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QDebug>
+
+DatabaseWorker::DatabaseWorker(const QString &databaseName, ConnectionProfile profile, QObject *parent)
+    : QObject(parent), context(new QObject()),
+      connectionName(QString("DatabaseWorker-%1").arg(reinterpret_cast<quintptr>(this), 0, 16)) {
+    thread.setObjectName("DatabaseWorker");
+    context->moveToThread(&thread);
+    connect(&thread, &QThread::finished, context, &QObject::deleteLater);
+    thread.start();
+
+    // Queued first, so it runs before any task.
+    QMetaObject::invokeMethod(context, [this, databaseName, profile]() {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databaseName);
+        if (!db.open()) {
+            qWarning() << "Database worker cannot open" << databaseName << "-" << db.lastError().text();
+        } else {
+            applyConnectionProfile(db, profile);
+        }
+        database = std::make_unique<FinanceDatabase>(connectionName);
+    }, Qt::QueuedConnection);
+}
+
+DatabaseWorker::~DatabaseWorker() {
+    QMetaObject::invokeMethod(context, [this]() {
+        database.reset();
+        {
+            QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+    }, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+}
@@ -0,0 +1,383 @@
+#include "FinanceDatabase.h"
+#include "IdGenerator.h"
+#include "Timestamp.h"
+#include <QSqlError>
+#include <QVariant>
+#include <QDebug>
+
+namespace {
+
+struct StatementSql {
+    const char *sql;
+    // Listing every account reads the whole table by design; every other
+    // statement must be answered through an index.
+    bool scanExpected;
+};
+
+// Indexed by FinanceDatabase::Statement.
+const StatementSql kStatementSql[] = {
+    {"SELECT balance_cents FROM accounts WHERE id = ?", false},
+    {"SELECT 1 FROM accounts WHERE id = ?", false},
+    {"SELECT id, username, owner, email, password, balance_cents, is_admin FROM accounts WHERE id = ?", false},
+    {"SELECT id, username, owner, email, password, balance_cents, is_admin FROM accounts", true},
+    {"SELECT date, amount_cents, type FROM transactions WHERE account_id = ? ORDER BY date DESC LIMIT ?", false},
+    {"INSERT INTO accounts (id, owner, username, email, password, balance_cents, is_admin) "
+     "VALUES (?, ?, ?, ?, ?, ?, ?)", false},
+    {"SELECT id, owner, password, is_admin FROM accounts WHERE username = ?", false},
+    {"UPDATE accounts SET balance_cents = balance_cents - ? WHERE id = ?", false},
+    {"UPDATE accounts SET balance_cents = balance_cents + ? WHERE id = ?", false},
+    {"INSERT INTO transactions (account_id, amount_cents, type, date) VALUES (?, ?, ?, ?)", false},
+    {"SAVEPOINT transfer", false},
+    {"RELEASE transfer", false},
+    {"ROLLBACK TO transfer", false},
+    {"SELECT COALESCE(MAX(seq), 0) FROM account_changes", false},
+    {"SELECT id, username, owner, email, password, balance_cents, is_admin FROM accounts "
+     "WHERE id IN (SELECT account_id FROM account_changes WHERE seq > ?)", false},
+    {"DELETE FROM account_changes WHERE seq < ?", false},
+    {"UPDATE accounts SET password = ? WHERE username = ?", false},
+    {"INSERT INTO id_node_leases DEFAULT VALUES", false},
+    {"DELETE FROM id_node_leases WHERE lease < ?", false},
+};
+
+static_assert(sizeof(kStatementSql) / sizeof(kStatementSql[0]) == 19, "one SQL string per statement");
+
+// The transactions.date text for now, in the local-time form Qt::ISODate
+// has always written there.
+QString currentDate() {
+    char buffer[kMaxTimestampChars];
+    const char *end = formatTimestamp(buffer, buffer + sizeof(buffer), currentTimestamp(), TimestampStyle::Iso8601);
+    return QString::fromLatin1(buffer, static_cast<int>(end - buffer));
+}
+
+}
+
+FinanceDatabase::FinanceDatabase(const QString &connectionName)
+    : connectionName(connectionName) {}
+
+FinanceDatabase::~FinanceDatabase() = default;
+
+QSqlDatabase FinanceDatabase::database() const {
+    return QSqlDatabase::database(connectionName);
+}
+
+QString FinanceDatabase::lastError() const {
+    return error;
+}
+
+QSqlQuery& FinanceDatabase::prepared(Statement statement) {
+    const size_t index = static_cast<size_t>(statement);
+    std::unique_ptr<QSqlQuery> &query = statements[index];
+    if (!query) {
+        query = std::make_unique<QSqlQuery>(database());
+        query->setForwardOnly(true);
+    }
+    if (!statementReady[index]) {
+        // A failed prepare (say, the database was locked) leaves the query
+        // unusable; it is prepared again on the next call instead of staying
+        // dead for the life of the connection.
+        statementReady[index] = query->prepare(QString::fromLatin1(kStatementSql[index].sql));
+        if (!statementReady[index]) {
+            qDebug() << "Error preparing statement:" << query->lastError().text();
+        }
+    }
+    return *query;
+}
+
+QStringList FinanceDatabase::tableScans() {
+    QStringList scans;
+    for (const StatementSql &statement : kStatementSql) {
+        if (statement.scanExpected) {
+            continue;
+        }
+        const QString sql = QString::fromLatin1(statement.sql);
+        QSqlQuery plan(database());
+        plan.setForwardOnly(true);
+        if (!plan.prepare("EXPLAIN QUERY PLAN " + sql)) {
+            scans << sql + " -- " + plan.lastError().text();
+            continue;
+        }
+        // The plan does not depend on the values, only on their presence.
+        for (int i = 0; i < sql.count('?'); ++i) {
+            plan.bindValue(i, QVariant(QString()));
+        }
+        if (!plan.exec()) {
+            scans << sql + " -- " + plan.lastError().text();
+            continue;
+        }
+        while (plan.next()) {
+            const QString detail = plan.value(3).toString();
+            if (detail.startsWith("SCAN ") || detail.contains("USE TEMP B-TREE")) {
+                scans << sql + " -- " + detail;
+            }
+        }
+    }
+    return scans;
+}
+
+bool FinanceDatabase::exec(QSqlQuery &query) {
+    if (!query.exec()) {
+        error = query.lastError().text();
+        qDebug() << "Query failed:" << error;
+        return false;
+    }
+    return true;
+}
+
+FinanceDatabase::AccountRecord FinanceDatabase::readAccount(const QSqlQuery &query) {
+    AccountRecord record;
+    record.id = query.value(0).toString();
+    record.username = query.value(1).toString();
+    record.owner = query.value(2).toString();
+    record.email = query.value(3).toString();
+    record.password = query.value(4).toString();
+    record.balance = Money::fromCents(query.value(5).toLongLong());
+    record.isAdmin = query.value(6).toBool();
+    return record;
+}
+
+std::optional<Money> FinanceDatabase::balance(const QString &accountId) {
+    QSqlQuery &query = prepared(Statement::SelectBalance);
+    query.bindValue(0, accountId);
+    std::optional<Money> result;
+    if (exec(query) && query.next()) {
+        result = Money::fromCents(query.value(0).toLongLong());
+    }
+    query.finish();
+    return result;
+}
+
+bool FinanceDatabase::accountExists(const QString &accountId) {
+    QSqlQuery &query = prepared(Statement::SelectAccountExists);
+    query.bindValue(0, accountId);
+    bool found = exec(query) && query.next();
+    query.finish();
+    return found;
+}
+
+std::optional<FinanceDatabase::AccountRecord> FinanceDatabase::account(const QString &accountId) {
+    QSqlQuery &query = prepared(Statement::SelectAccount);
+    query.bindValue(0, accountId);
+    std::optional<AccountRecord> result;
+    if (exec(query) && query.next()) {
+        result = readAccount(query);
+    }
+    query.finish();
+    return result;
+}
+
+QVector<FinanceDatabase::AccountRecord> FinanceDatabase::accounts() {
+    QSqlQuery &query = prepared(Statement::SelectAllAccounts);
+    QVector<AccountRecord> result;
+    if (exec(query)) {
+        while (query.next()) {
+            result.append(readAccount(query));
+        }
+    }
+    query.finish();
+    return result;
+}
+
+QVector<FinanceDatabase::PostingRecord> FinanceDatabase::recentPostings(const QString &accountId, int limit) {
+    QSqlQuery &query = prepared(Statement::SelectRecentPostings);
+    query.bindValue(0, accountId);
+    query.bindValue(1, limit);
+    QVector<PostingRecord> result;
+    if (exec(query)) {
+        while (query.next()) {
+            PostingRecord posting;
+            posting.date = query.value(0).toString();
+            posting.amount = Money::fromCents(query.value(1).toLongLong());
+            posting.type = query.value(2).toString();
+            result.append(posting);
+        }
+    }
+    query.finish();
+    return result;
+}
+
+bool FinanceDatabase::insertAccount(const AccountRecord &account) {
+    QSqlQuery &query = prepared(Statement::InsertAccount);
+    query.bindValue(0, account.id);
+    query.bindValue(1, account.owner);
+    query.bindValue(2, account.username);
+    query.bindValue(3, account.email);
+    query.bindValue(4, account.password);
+    query.bindValue(5, qlonglong(account.balance.getCents()));
+    query.bindValue(6, account.isAdmin);
+    return exec(query);
+}
+
+std::optional<uint32_t> FinanceDatabase::leaseIdNode() {
+    QSqlQuery &insert = prepared(Statement::InsertIdNodeLease);
+    if (!exec(insert)) {
+        return std::nullopt;
+    }
+    const qint64 lease = insert.lastInsertId().toLongLong();
+    insert.finish();
+    // Only the newest lease matters; AUTOINCREMENT remembers the counter.
+    QSqlQuery &prune = prepared(Statement::PruneIdNodeLeases);
+    prune.bindValue(0, lease);
+    exec(prune);
+    return static_cast<uint32_t>(lease % (qint64(IdGenerator::kMaxNode) + 1));
+}
+
+qint64 FinanceDatabase::changeSequence() {
+    QSqlQuery &query = prepared(Statement::SelectChangeSequence);
+    qint64 sequence = 0;
+    if (exec(query) && query.next()) {
+        sequence = query.value(0).toLongLong();
+    }
+    query.finish();
+    return sequence;
+}
+
+QVector<FinanceDatabase::AccountRecord> FinanceDatabase::accountsChangedSince(qint64 sequence) {
+    QSqlQuery &query = prepared(Statement::SelectAccountsChangedSince);
+    query.bindValue(0, sequence);
+    QVector<AccountRecord> result;
+    if (exec(query)) {
+        while (query.next()) {
+            result.append(readAccount(query));
+        }
+    }
+    query.finish();
+    return result;
+}
+
+bool FinanceDatabase::pruneChanges(qint64 upTo) {
+    QSqlQuery &query = prepared(Statement::PruneChanges);
+    query.bindValue(0, upTo);
+    return exec(query);
+}
+
+std::optional<FinanceDatabase::LoginRecord> FinanceDatabase::login(const QString &username) {
+    QSqlQuery &query = prepared(Statement::SelectLogin);
+    query.bindValue(0, username);
+    std::optional<LoginRecord> result;
+    if (exec(query) && query.next()) {
+        LoginRecord record;
+        record.accountId = query.value(0).toString();
+        record.owner = query.value(1).toString();
+        record.credential = query.value(2).toString();
+        record.isAdmin = query.value(3).toBool();
+        result = record;
+    }
+    query.finish();
+    return result;
+}
+
+bool FinanceDatabase::setPassword(const QString &username, const QString &passwordHash) {
+    QSqlQuery &query = prepared(Statement::UpdatePassword);
+    query.bindValue(0, passwordHash);
+    query.bindValue(1, username);
+    return exec(query) && query.numRowsAffected() == 1;
+}
+
+FinanceDatabase::TransferStatus FinanceDatabase::transfer(const QString &sourceId, const QString &destinationId,
+                                                          const Money &amount) {
+    QSqlDatabase db = database();
+    if (!db.transaction()) {
+        error = db.lastError().text();
+        return TransferStatus::Failed;
+    }
+
+    TransferStatus status = applyTransfer(sourceId, destinationId, amount, currentDate());
+    if (status != TransferStatus::Ok) {
+        db.rollback();
+        return status;
+    }
+    if (!db.commit()) {
+        error = db.lastError().text();
+        db.rollback();
+        return TransferStatus::Failed;
+    }
+    return TransferStatus::Ok;
+}
+
+QVector<FinanceDatabase::TransferStatus> FinanceDatabase::transferBatch(const QVector<TransferRecord> &transfers) {
+    QVector<TransferStatus> results(transfers.size(), TransferStatus::Failed);
+    if (transfers.isEmpty()) {
+        return results;
+    }
+
+    QSqlDatabase db = database();
+    if (!db.transaction()) {
+        error = db.lastError().text();
+        return results;
+    }
+
+    const QString date = currentDate();
+    QSqlQuery &savepoint = prepared(Statement::Savepoint);
+    QSqlQuery &release = prepared(Statement::ReleaseSavepoint);
+    QSqlQuery &rollbackTo = prepared(Statement::RollbackToSavepoint);
+    for (int i = 0; i < transfers.size(); ++i) {
+        const TransferRecord &transfer = transfers[i];
+        if (!exec(savepoint)) {
+            db.rollback();
+            results.fill(TransferStatus::Failed);
+            return results;
+        }
+        results[i] = applyTransfer(transfer.sourceId, transfer.destinationId, transfer.amount, date);
+        // ROLLBACK TO keeps the savepoint open, so it is released either way.
+        if ((results[i] != TransferStatus::Ok && !exec(rollbackTo)) || !exec(release)) {
+            db.rollback();
+            results.fill(TransferStatus::Failed);
+            return results;
+        }
+    }
+
+    if (!db.commit()) {
+        error = db.lastError().text();
+        db.rollback();
+        results.fill(TransferStatus::Failed);
+    }
+    return results;
+}
+
+// Does the checks and writes of one transfer; the caller owns the enclosing
+// transaction and undoes the partial writes when this fails.
+FinanceDatabase::TransferStatus FinanceDatabase::applyTransfer(const QString &sourceId, const QString &destinationId,
+                                                               const Money &amount, const QString &date) {
+    // Without these a negative amount would move money backwards.
+    if (amount <= Money::fromCents(0)) {
+        return TransferStatus::InvalidAmount;
+    }
+    if (sourceId == destinationId) {
+        return TransferStatus::SameAccount;
+    }
+    std::optional<Money> sourceBalance = balance(sourceId);
+    if (!sourceBalance) {
+        return TransferStatus::UnknownSource;
+    }
+    if (!accountExists(destinationId)) {
+        return TransferStatus::UnknownDestination;
+    }
+    if (*sourceBalance < amount) {
+        return TransferStatus::InsufficientFunds;
+    }
+
+    QSqlQuery &debit = prepared(Statement::Debit);
+    debit.bindValue(0, qlonglong(amount.getCents()));
+    debit.bindValue(1, sourceId);
+    QSqlQuery &credit = prepared(Statement::Credit);
+    credit.bindValue(0, qlonglong(amount.getCents()));
+    credit.bindValue(1, destinationId);
+    if (!exec(debit) || !exec(credit)) {
+        return TransferStatus::Failed;
+    }
+
+    QSqlQuery &posting = prepared(Statement::InsertPosting);
+    posting.bindValue(0, sourceId);
+    posting.bindValue(1, qlonglong((-amount).getCents()));
+    posting.bindValue(2, QStringLiteral("TRANSFER"));
+    posting.bindValue(3, date);
+    if (!exec(posting)) {
+        return TransferStatus::Failed;
+    }
+    posting.bindValue(0, destinationId);
+    posting.bindValue(1, qlonglong(amount.getCents()));
+    if (!exec(posting)) {
+        return TransferStatus::Failed;
+    }
+    return TransferStatus::Ok;
+}
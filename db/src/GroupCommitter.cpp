@@ -0,0 +1,51 @@
+#include "GroupCommitter.h"
+
+GroupCommitter::GroupCommitter(FinanceDatabase *database, int windowMs, int maxBatch, QObject *parent)
+    : QObject(parent), database(database), maxBatch(maxBatch) {
+    timer.setSingleShot(true);
+    timer.setInterval(windowMs);
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &GroupCommitter::flush);
+}
+
+GroupCommitter::~GroupCommitter() {
+    // The database may already be gone here, so nothing is committed.
+    Q_ASSERT_X(queued.isEmpty(), "GroupCommitter", "destroyed with transfers still queued; flush() first");
+}
+
+void GroupCommitter::submit(const QString &sourceId, const QString &destinationId, const Money &amount,
+                            Completion done) {
+    queued.append({sourceId, destinationId, amount});
+    completions.append(std::move(done));
+    if (queued.size() >= maxBatch) {
+        flush();
+    } else if (!timer.isActive()) {
+        // The window opens with the first transfer; later ones don't extend it.
+        timer.start();
+    }
+}
+
+int GroupCommitter::pending() const {
+    return queued.size();
+}
+
+void GroupCommitter::flush() {
+    timer.stop();
+    if (queued.isEmpty()) {
+        return;
+    }
+
+    // Swap out first: a completion may submit the next transfer.
+    QVector<FinanceDatabase::TransferRecord> batch;
+    QVector<Completion> done;
+    batch.swap(queued);
+    done.swap(completions);
+
+    const QVector<FinanceDatabase::TransferStatus> results = database->transferBatch(batch);
+    emit batchCommitted(batch.size());
+    for (int i = 0; i < done.size(); ++i) {
+        if (done[i]) {
+            done[i](results[i]);
+        }
+    }
+}
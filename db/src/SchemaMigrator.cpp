@@ -0,0 +1,196 @@
+#include "SchemaMigrator.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+#include <QDebug>
+
+namespace {
+
+struct Migration {
+    int version;
+    const char *description;
+    bool (SchemaMigrator::*apply)();
+};
+
+}
+
+SchemaMigrator::SchemaMigrator(const QSqlDatabase &db) : db(db) {}
+
+int SchemaMigrator::latestVersion() {
+    return 6;
+}
+
+int SchemaMigrator::version() const {
+    QSqlQuery query(db);
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return -1;
+}
+
+QString SchemaMigrator::lastError() const {
+    return error;
+}
+
+bool SchemaMigrator::migrate() {
+    // Append new steps at the end; never edit one that has shipped.
+    static const Migration migrations[] = {
+        {1, "base schema", &SchemaMigrator::createBaseSchema},
+        {2, "integer cents", &SchemaMigrator::convertToIntegerCents},
+        {3, "hot query indexes", &SchemaMigrator::createHotQueryIndexes},
+        {4, "account change log", &SchemaMigrator::createAccountChangeLog},
+        {5, "narrow account change trigger", &SchemaMigrator::narrowAccountChangeTrigger},
+        {6, "id node leases", &SchemaMigrator::createIdNodeLeases},
+    };
+
+    int current = version();
+    if (current < 0) {
+        error = "Could not read schema version";
+        return false;
+    }
+
+    for (const Migration &migration : migrations) {
+        if (migration.version <= current) {
+            continue;
+        }
+        qDebug() << "Applying schema migration" << migration.version << "-" << migration.description;
+        if (!db.transaction()) {
+            error = db.lastError().text();
+            return false;
+        }
+        if (!(this->*migration.apply)() || !exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+            qDebug() << "Schema migration" << migration.version << "failed:" << error;
+            db.rollback();
+            return false;
+        }
+        if (!db.commit()) {
+            error = db.lastError().text();
+            db.rollback();
+            return false;
+        }
+        current = migration.version;
+    }
+    return true;
+}
+
+bool SchemaMigrator::exec(const QString &statement) {
+    QSqlQuery query(db);
+    if (!query.exec(statement)) {
+        error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SchemaMigrator::hasColumn(const QString &table, const QString &column) const {
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA table_info(" + table + ")")) {
+        return false;
+    }
+    while (query.next()) {
+        if (query.value("name").toString() == column) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Databases that predate versioning already have these tables (possibly in
+// the REAL-dollar layout that step 2 converts), so they are created only if
+// missing.
+bool SchemaMigrator::createBaseSchema() {
+    return exec("CREATE TABLE IF NOT EXISTS accounts ("
+                "id TEXT PRIMARY KEY, "
+                "username TEXT NOT NULL UNIQUE, "
+                "owner TEXT, "
+                "email TEXT UNIQUE, "
+                "password TEXT NOT NULL, "
+                "balance_cents INTEGER NOT NULL DEFAULT 0, "
+                "is_admin INTEGER NOT NULL)")
+        && exec("CREATE TABLE IF NOT EXISTS transactions ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "account_id TEXT, "
+                "amount_cents INTEGER NOT NULL, "
+                "type TEXT, "
+                "date TEXT, "
+                "FOREIGN KEY (account_id) REFERENCES accounts(id))");
+}
+
+// Older databases keep balance/amount as REAL dollars. Rebuild those tables,
+// rounding every value to the nearest cent.
+bool SchemaMigrator::convertToIntegerCents() {
+    QStringList statements;
+    if (hasColumn("transactions", "amount")) {
+        statements << "CREATE TABLE transactions_new ("
+                      "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                      "account_id TEXT, "
+                      "amount_cents INTEGER NOT NULL, "
+                      "type TEXT, "
+                      "date TEXT, "
+                      "FOREIGN KEY (account_id) REFERENCES accounts(id))"
+                   << "INSERT INTO transactions_new (id, account_id, amount_cents, type, date) "
+                      "SELECT id, account_id, CAST(ROUND(COALESCE(amount, 0) * 100) AS INTEGER), type, date "
+                      "FROM transactions"
+                   << "DROP TABLE transactions"
+                   << "ALTER TABLE transactions_new RENAME TO transactions";
+    }
+    if (hasColumn("accounts", "balance")) {
+        statements << "CREATE TABLE accounts_new ("
+                      "id TEXT PRIMARY KEY, "
+                      "username TEXT NOT NULL UNIQUE, "
+                      "owner TEXT, "
+                      "email TEXT UNIQUE, "
+                      "password TEXT NOT NULL, "
+                      "balance_cents INTEGER NOT NULL DEFAULT 0, "
+                      "is_admin INTEGER NOT NULL)"
+                   << "INSERT INTO accounts_new (id, username, owner, email, password, balance_cents, is_admin) "
+                      "SELECT id, username, owner, email, password, "
+                      "CAST(ROUND(COALESCE(balance, 0) * 100) AS INTEGER), is_admin FROM accounts"
+                   << "DROP TABLE accounts"
+                   << "ALTER TABLE accounts_new RENAME TO accounts";
+    }
+    for (const QString &statement : statements) {
+        if (!exec(statement)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The account view reads the newest postings of one account. Covering the
+// selected columns answers it from the index alone, already in date order.
+// Username and id lookups are served by the UNIQUE/PRIMARY KEY indexes.
+bool SchemaMigrator::createHotQueryIndexes() {
+    return exec("CREATE INDEX IF NOT EXISTS idx_transactions_account_date "
+                "ON transactions (account_id, date DESC, amount_cents, type)");
+}
+
+// Every insert or update of an account appends its id, so a reader holding
+// an account snapshot taken at some seq can fetch just the accounts changed
+// after it. AUTOINCREMENT keeps seq increasing after old entries are pruned.
+bool SchemaMigrator::createAccountChangeLog() {
+    return exec("CREATE TABLE IF NOT EXISTS account_changes ("
+                "seq INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "account_id TEXT NOT NULL)")
+        && exec("CREATE TRIGGER IF NOT EXISTS accounts_log_insert AFTER INSERT ON accounts "
+                "BEGIN INSERT INTO account_changes (account_id) VALUES (NEW.id); END")
+        && exec("CREATE TRIGGER IF NOT EXISTS accounts_log_update AFTER UPDATE ON accounts "
+                "BEGIN INSERT INTO account_changes (account_id) VALUES (NEW.id); END");
+}
+
+// Only log updates to the columns an account snapshot holds, so rehashing a
+// password, for one, does not make readers reload the account.
+bool SchemaMigrator::narrowAccountChangeTrigger() {
+    return exec("DROP TRIGGER IF EXISTS accounts_log_update")
+        && exec("CREATE TRIGGER accounts_log_update "
+                "AFTER UPDATE OF id, owner, username, email, balance_cents, is_admin ON accounts "
+                "BEGIN INSERT INTO account_changes (account_id) VALUES (NEW.id); END");
+}
+
+// Hands out IdGenerator nodes (FinanceDatabase::leaseIdNode); the lease
+// counter survives pruning because of AUTOINCREMENT.
+bool SchemaMigrator::createIdNodeLeases() {
+    return exec("CREATE TABLE IF NOT EXISTS id_node_leases ("
+                "lease INTEGER PRIMARY KEY AUTOINCREMENT)");
+}
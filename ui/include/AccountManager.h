@@ -2,12 +2,28 @@
 #define ACCOUNTMANAGER_H
 
 #include <QWidget>
+#include <QFuture>
 #include <QList>
 #include <QString>
+#include <QVector>
+#include <memory>
+#include <optional>
+#include <vector>
 #include "Bank.h"
 #include "Account.h"
+#include "AccountSnapshot.h"
+#include "Arena.h"
+#include "IdGenerator.h"
+#include "StringPool.h"
+#include "FinanceDatabase.h"
+#include "Session.h"
 
-class QTableWidget;
+class QTableView;
+class QLineEdit;
+class QModelIndex;
+class AccountTableModel;
+class AccountFilterProxy;
+class DatabaseWorker;
 class QTextEdit;
 class QPushButton;
 class QDialog;
@@ -18,14 +34,17 @@ class AccountManager : public QWidget {
     Q_OBJECT
 
 public:
-    explicit AccountManager(Bank *bank, QWidget *parent = nullptr);
+    // All SQL runs on worker. databaseName locates the account snapshot,
+    // which is kept beside the database file.
+    AccountManager(Bank *bank, DatabaseWorker *worker, const QString &databaseName, QWidget *parent = nullptr);
     ~AccountManager();
 
-    void setUserAccess(const QString &username, bool isAdmin);
+    void setUserAccess(const Session &session);
     void clearData();
 
 public slots:
-    void onTransactionCompleted();
+    // Patches the rows and the detail view of the changed accounts only.
+    void onTransactionCompleted(const QVector<FinanceDatabase::BalanceRecord> &changes);
 
 signals:
     void logoutRequested();
@@ -34,17 +53,63 @@ private slots:
     void showUserMenu();
     void logout();
     void showCreateAccountForm();
-    void showAccountDetails(int row, int column);
+    void showAccountDetails(const QModelIndex &index);
 public slots:
     QPushButton* getUserButton() { return userButton; }
 
 private:
+    struct AccountDetails {
+        std::optional<FinanceDatabase::AccountRecord> record;
+        QVector<FinanceDatabase::PostingRecord> postings;
+    };
+
+    // What a load reads on the database worker: the snapshot to show and the
+    // accounts to overlay on it.
+    struct AccountLoad {
+        std::shared_ptr<AccountSnapshot> snapshot;
+        QVector<FinanceDatabase::AccountRecord> records;
+    };
+
     Bank *bank;
-    QList<Account*> allAccounts;
-    QTableWidget *accountTable;
+    DatabaseWorker *worker;
+    // Everything one load produces. Accounts are read from the snapshot, with
+    // the accounts changed since it was written materialized in the arena and
+    // their snapshot rows superseded.
+    struct AccountGeneration {
+        std::shared_ptr<AccountSnapshot> snapshot;
+        std::vector<bool> superseded;
+        StringPool strings;
+        Arena arena;
+        QList<Account*> accounts;
+
+        // Drops the accounts and their text but keeps the arena's blocks.
+        void reset() {
+            accounts.clear();
+            arena.reset();
+            strings.clear();
+        }
+    };
+
+    // The model reads from `current`. A load builds into `spare` and swaps
+    // the two only after handing the model the new rows, so the previous
+    // generation is never freed while something still points into it.
+    std::unique_ptr<AccountGeneration> current;
+    std::unique_ptr<AccountGeneration> spare;
+    // Created once an admin logs in, with a node leased from the database.
+    std::unique_ptr<IdGenerator> accountIds;
+    bool leasingIdNode;
+    // At most one load runs at a time, so each starts from the snapshot the
+    // previous one left; a load requested meanwhile runs after it.
+    bool loadRunning;
+    bool reloadRequested;
+    QString snapshotPath;
+    QString displayedAccountId;
+    QTableView *accountTable;
+    AccountTableModel *accountModel;
+    AccountFilterProxy *accountProxy;
+    QLineEdit *accountFilter;
     QPushButton *userButton;
-    QString currentUser;
-    bool isAdminUser;
+    Session session;
 
     // Widgets for user mode
     QWidget *userViewWidget;
@@ -57,12 +122,22 @@ private:
 
     void setupUI();
     void loadAccountsFromDatabase();
+    void applyAccountLoad(const AccountLoad &load);
+    // Run on the database worker; they touch no member.
+    static AccountLoad readAccounts(FinanceDatabase &db, std::shared_ptr<AccountSnapshot> snapshot,
+                                    const QString &snapshotPath);
+    static std::shared_ptr<AccountSnapshot> openSnapshot(FinanceDatabase &db, const QString &snapshotPath);
+    static AccountLoad refreshSnapshot(FinanceDatabase &db, const QString &snapshotPath);
+    void leaseIdNode();
     void updateAccountList();
     void displayAccountDetails(const QString &accountId);
-    void saveAccountToDatabase(const Account* account);
+    void renderAccountDetails(const QString &accountId, const AccountDetails &details);
+    void showBalance(const Money &balance);
+    // Inserts on the worker; the future holds the database's error, empty
+    // on success.
+    QFuture<QString> saveAccountToDatabase(const Account* account);
     QString generateUniqueAccountId();
     QDialog* setupAccountCreationDialog();
-    std::string getCurrentUserAccountId();
 };
 
 #endif // ACCOUNTMANAGER_H
\ No newline at end of file
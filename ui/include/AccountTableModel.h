@@ -0,0 +1,77 @@
+#ifndef ACCOUNTTABLEMODEL_H
+#define ACCOUNTTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Account.h"
+#include "AccountSnapshot.h"
+
+// Table model over the accounts AccountManager holds: rows straight from the
+// mapped snapshot followed by the materialized accounts that changed since.
+// Nothing is formatted or converted until the view asks for a visible cell,
+// and a row costs one index, so the view stays fast at any account count.
+class AccountTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { IdColumn, OwnerColumn, BalanceColumn, ColumnCount };
+
+    explicit AccountTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // snapshotRows must be ascending. Neither the snapshot nor the accounts
+    // are owned; they must outlive the next setAccounts() or clear().
+    void setAccounts(const AccountSnapshot *snapshot, std::vector<uint32_t> snapshotRows,
+                     QList<const Account*> accounts);
+    void clear();
+    // Updates one balance in place; unknown ids are ignored.
+    void setBalance(const QString &accountId, const Money &balance);
+
+    QString accountId(int row) const;
+    // Raw comparisons for the proxy, without building QVariants or QStrings.
+    bool lessThan(int left, int right, int column) const;
+    // foldedText is UTF-8 with ASCII letters already lowercased.
+    bool contains(int row, std::string_view foldedText) const;
+
+private:
+    const AccountSnapshot *snapshot;
+    std::vector<uint32_t> snapshotRows;
+    QList<const Account*> accounts;
+    // Balances patched since the last setAccounts(), by row.
+    QHash<int, Money> balanceUpdates;
+
+    std::string_view idAt(int row) const;
+    std::string_view ownerAt(int row) const;
+    Money balanceAt(int row) const;
+};
+
+// Sorts and filters an AccountTableModel through its raw accessors. The
+// filter matches the stored UTF-8 account id or owner, ignoring the case of
+// ASCII letters, so a keystroke converts nothing per row.
+class AccountFilterProxy : public QSortFilterProxyModel {
+    Q_OBJECT
+
+public:
+    explicit AccountFilterProxy(QObject *parent = nullptr);
+
+    void setFilterText(const QString &text);
+
+protected:
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    std::string filterText;
+};
+
+#endif // ACCOUNTTABLEMODEL_H
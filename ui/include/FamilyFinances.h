@@ -6,7 +6,9 @@
 #include "LoginPage.h"
 #include "AccountManager.h"
 #include "TransactionManager.h"
+#include "Session.h"
 
+class DatabaseWorker;
 class QFrame;
 
 class FamilyFinances : public QMainWindow {
@@ -20,21 +22,21 @@ protected:
     void closeEvent(QCloseEvent *event) override;
 
 private slots:
-    void onLoginSuccessful(const QString &username, bool isAdmin);
+    void onLoginSuccessful(const Session &session);
     void onLogoutRequested();
 
 private:
     Bank *bank;
+    DatabaseWorker *worker;
     LoginPage *loginPage;
     QWidget *bankWidget;
     AccountManager *accountManager;
     TransactionManager *transactionManager;
-    QString currentUser;
-    bool isAdminUser;
+    Session session;
 
     bool initializeDatabase();
     void setupUI();
-    void setUserAccess(const QString &username, bool isAdmin);
+    void setUserAccess(const Session &session);
     QFrame* createStyledFrame();
 };
 
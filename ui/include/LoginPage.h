@@ -3,15 +3,18 @@
 #include <QWidget>
 #include <QLineEdit>
 #include <QPushButton>
+#include "Session.h"
+
+class DatabaseWorker;
 
 class LoginPage : public QWidget {
     Q_OBJECT
 
 public:
-    explicit LoginPage(QWidget *parent = nullptr);
+    explicit LoginPage(DatabaseWorker *worker, QWidget *parent = nullptr);
 
 signals:
-    void loginSuccessful(const QString &username, bool isAdmin);
+    void loginSuccessful(const Session &session);
 
 private slots:
     void attemptLogin();
@@ -23,9 +26,9 @@ public slots:
 
 private:
     void setupUI();
-    bool authenticateUser(const QString &username, const QString &password);
-    bool checkIfAdmin(const QString &username);
+    void setPending(bool pending);
 
+    DatabaseWorker *worker;
     QLineEdit *usernameInput;
     QLineEdit *passwordInput;
     QPushButton *loginButton;
@@ -0,0 +1,16 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <QString>
+
+// The logged-in user, resolved once by the login query. FamilyFinances hands
+// it to every view, so nothing after login looks the user up again.
+struct Session {
+    QString accountId;
+    QString username;
+    // The account owner's name, for display.
+    QString displayName;
+    bool isAdmin = false;
+};
+
+#endif // SESSION_H
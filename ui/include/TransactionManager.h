@@ -5,35 +5,39 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
-#include "Bank.h"
+#include <QVector>
+#include "FinanceDatabase.h"
+#include "Session.h"
+
+class DatabaseWorker;
 
 class TransactionManager : public QWidget {
     Q_OBJECT
 
 public:
-    explicit TransactionManager(Bank *bank, QWidget *parent = nullptr);
-    void setUserAccess(const QString &username, bool isAdmin);
+    explicit TransactionManager(DatabaseWorker *worker, QWidget *parent = nullptr);
+    void setUserAccess(const Session &session);
     void clearData();
 
 signals:
-    void transactionCompleted();
+    // Carries the new balance of every account the transaction touched.
+    void transactionCompleted(const QVector<FinanceDatabase::BalanceRecord> &changes);
 
 private slots:
     void performTransaction();
 
 private:
-    Bank *bank;
+    DatabaseWorker *worker;
     QLineEdit *sourceInput;
     QLineEdit *destInput;
     QLineEdit *amountInput;
     QPushButton *transferButton;
     QLabel *statusLabel;
-    QString currentUser;
-    bool isAdminUser;
+    Session session;
 
     void setupUI();
     void setupConnections();
-    QString getUserAccountId(const QString &username);
+    void setPending(bool pending);
 };
 
 #endif // TRANSACTIONMANAGER_H
\ No newline at end of file
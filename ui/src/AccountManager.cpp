@@ -1,4 +1,10 @@
 #include "AccountManager.h"
+#include "AccountTableModel.h"
+#include "DatabaseWorker.h"
+#include "FinanceDatabase.h"
+#include "IdGenerator.h"
+#include "MoneyFormat.h"
+#include "PasswordHasher.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
@@ -7,25 +13,49 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QMessageBox>
-#include <QDateTime>
-#include <QSqlDatabase>
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QDebug>
 #include <QMenu>
 #include <QGroupBox>
-#include <QTableWidget>
+#include <QTableView>
 #include <QListWidget>
+#include <QFileInfo>
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Once the change log holds this many entries past the snapshot, the next
+// load writes a fresh snapshot, which also prunes the log. Every transfer
+// logs both of its accounts, so this bounds the log rather than the number
+// of distinct accounts changed.
+constexpr qint64 kSnapshotRefreshRows = 4096;
+
+// The accounts table stores no minimum balance and these accounts are only
+// displayed, so they get none: the lowest amount an Account accepts.
+constexpr Money kNoMinimum = Money::fromCents(std::numeric_limits<int64_t>::min() + 1);
+
+QString toQString(std::string_view text) {
+    return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+}
+
+}
 
-AccountManager::AccountManager(Bank *bank, QWidget *parent)
-    : QWidget(parent), bank(bank), isAdminUser(false) {
+AccountManager::AccountManager(Bank *bank, DatabaseWorker *worker, const QString &databaseName, QWidget *parent)
+    : QWidget(parent), bank(bank), worker(worker),
+      current(std::make_unique<AccountGeneration>()), spare(std::make_unique<AccountGeneration>()),
+      leasingIdNode(false), loadRunning(false), reloadRequested(false) {
+    if (!databaseName.isEmpty() && databaseName != ":memory:") {
+        snapshotPath = QFileInfo(databaseName).absoluteFilePath() + ".snapshot";
+    }
     setupUI();
     loadAccountsFromDatabase();
 }
 
-AccountManager::~AccountManager() {
-    qDeleteAll(allAccounts);
-}
+AccountManager::~AccountManager() = default;
 
 void AccountManager::setupUI() {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -59,18 +89,36 @@ void AccountManager::setupUI() {
     mainLayout->addLayout(headerLayout);
 
     // Admin View: Account Table
-    accountTable = new QTableWidget(this);
+    accountFilter = new QLineEdit(this);
+    accountFilter->setPlaceholderText("Filter by account ID or owner");
+    accountFilter->setClearButtonEnabled(true);
+    mainLayout->addWidget(accountFilter);
+
+    accountModel = new AccountTableModel(this);
+    accountProxy = new AccountFilterProxy(this);
+    accountProxy->setSourceModel(accountModel);
+
+    accountTable = new QTableView(this);
     accountTable->setObjectName("accountTable");
-    accountTable->setColumnCount(3);
-    accountTable->setHorizontalHeaderLabels({"Account ID", "Owner", "Balance"});
+    accountTable->setModel(accountProxy);
+    accountTable->setSortingEnabled(true);
+    accountTable->sortByColumn(AccountTableModel::IdColumn, Qt::AscendingOrder);
+    accountTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    accountTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    accountTable->setWordWrap(false);
+    // Fixed row heights let the view lay out a million rows without
+    // measuring any of them.
+    accountTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    accountTable->verticalHeader()->hide();
     accountTable->horizontalHeader()->setStretchLastSection(true);
     accountTable->setStyleSheet(
-        "QTableWidget { border: 1px solid #CCCCCC; border-radius: 4px; }"
+        "QTableView { border: 1px solid #CCCCCC; border-radius: 4px; }"
         "QHeaderView::section { background-color: #333333; color: white; padding: 5px; }"
-        "QTableWidget::item { padding: 5px; }"
+        "QTableView::item { padding: 5px; }"
     );
-    connect(accountTable, &QTableWidget::cellClicked, this, &AccountManager::showAccountDetails);
-    
+    connect(accountTable, &QTableView::clicked, this, &AccountManager::showAccountDetails);
+    connect(accountFilter, &QLineEdit::textChanged, accountProxy, &AccountFilterProxy::setFilterText);
+
     mainLayout->addWidget(accountTable);
 
     // User View: Account Details and Transactions
@@ -112,6 +160,7 @@ void AccountManager::setupUI() {
     setLayout(mainLayout);
 
     // Initially hide both views
+    accountFilter->hide();
     accountTable->hide();
     userViewWidget->hide();
 }
@@ -133,7 +182,7 @@ void AccountManager::showUserMenu() {
                         "    color: white;"
                         "}");
 
-    if (isAdminUser) {
+    if (session.isAdmin) {
         QAction *addAccountAction = new QAction("Add/Update Account", this); // same username then update will be performed.
         connect(addAccountAction, &QAction::triggered, this, &AccountManager::showCreateAccountForm);
         menu->addAction(addAccountAction);
@@ -153,130 +202,252 @@ void AccountManager::logout() {
     emit logoutRequested();
 }
 
+// Maps the snapshot file left by an earlier run, if it belongs to this
+// database.
+std::shared_ptr<AccountSnapshot> AccountManager::openSnapshot(FinanceDatabase &db, const QString &snapshotPath) {
+    if (snapshotPath.isEmpty() || !QFileInfo::exists(snapshotPath)) {
+        return nullptr;
+    }
+    std::shared_ptr<AccountSnapshot> opened;
+    try {
+        opened = std::make_shared<AccountSnapshot>(snapshotPath.toStdString());
+    } catch (const std::runtime_error &e) {
+        qWarning() << "Ignoring account snapshot:" << e.what();
+        return nullptr;
+    }
+    // A snapshot newer than the change log belongs to some other database.
+    if (opened->sequence() > static_cast<quint64>(db.changeSequence())) {
+        return nullptr;
+    }
+    return opened;
+}
+
+// Reads every account, writes them as a new snapshot and returns it with the
+// accounts to overlay on it: the ones changed while it was being written, or
+// all of them if no snapshot could be written. The snapshot is replaced by
+// rename, so a mapping the model still reads stays valid.
+AccountManager::AccountLoad AccountManager::refreshSnapshot(FinanceDatabase &db, const QString &snapshotPath) {
+    AccountLoad load;
+    // Read the position first, so changes racing the full read are replayed.
+    const qint64 sequence = db.changeSequence();
+    load.records = db.accounts();
+    if (snapshotPath.isEmpty()) {
+        return load;
+    }
+
+    try {
+        AccountSnapshot::Writer writer;
+        writer.reserve(load.records.size());
+        for (const FinanceDatabase::AccountRecord &record : load.records) {
+            writer.add(record.id.toStdString(), record.owner.toStdString(), record.username.toStdString(),
+                       record.email.toStdString(), kNoMinimum, record.balance, record.isAdmin);
+        }
+        writer.write(snapshotPath.toStdString(), sequence);
+        load.snapshot = std::make_shared<AccountSnapshot>(snapshotPath.toStdString());
+    } catch (const std::exception &e) {
+        qWarning() << "Could not write account snapshot:" << e.what();
+        load.snapshot.reset();
+        return load;
+    }
+    db.pruneChanges(sequence);
+    load.records = db.accountsChangedSince(sequence);
+    return load;
+}
+
+AccountManager::AccountLoad AccountManager::readAccounts(FinanceDatabase &db, std::shared_ptr<AccountSnapshot> snapshot,
+                                                         const QString &snapshotPath) {
+    if (!snapshot) {
+        snapshot = openSnapshot(db, snapshotPath);
+    }
+    if (!snapshot || db.changeSequence() - qint64(snapshot->sequence()) > kSnapshotRefreshRows) {
+        return refreshSnapshot(db, snapshotPath);
+    }
+    AccountLoad load;
+    load.snapshot = std::move(snapshot);
+    load.records = db.accountsChangedSince(load.snapshot->sequence());
+    // Entries the snapshot already reflects are never read again.
+    db.pruneChanges(qint64(load.snapshot->sequence()));
+    return load;
+}
+
+// Reads on the database worker, then builds the new generation here. The
+// model keeps showing the current one until then.
 void AccountManager::loadAccountsFromDatabase() {
-    allAccounts.clear();
-    QSqlQuery query("SELECT * FROM accounts");
-    while (query.next()) {
-        QString id = query.value("id").toString();
-        std::string owner = query.value("owner").toString().toStdString();
-        std::string username = query.value("username").toString().toStdString();
-        QString email = query.value("email").toString();
-        QString password = query.value("password").toString();
-        double balance = query.value("balance").toDouble();
-        bool isAdmin = query.value("is_admin").toBool();
-
-        Money current = Money::fromDollars(balance);
-        Money minimum = Money::fromDollars(0);
-
-        Account* account = new Account(owner, id.toStdString(), minimum, current);
-        account->setUsername(username);
-        account->setEmail(email.toStdString());
-        account->setPassword(password.toStdString());
-        account->setIsAdmin(isAdmin);
-        allAccounts.append(account);
+    if (loadRunning) {
+        reloadRequested = true;
+        return;
     }
-    updateAccountList();
+    loadRunning = true;
+    std::shared_ptr<AccountSnapshot> snapshot = current->snapshot;
+    const QString path = snapshotPath;
+    worker->run([snapshot, path](FinanceDatabase &db) {
+        return readAccounts(db, snapshot, path);
+    }).then(this, [this](const AccountLoad &load) {
+        applyAccountLoad(load);
+    }).onFailed(this, []() {
+        qWarning() << "Could not load the accounts";
+    }).then(this, [this]() {
+        loadRunning = false;
+        if (reloadRequested) {
+            reloadRequested = false;
+            loadAccountsFromDatabase();
+        }
+    });
 }
 
-void AccountManager::updateAccountList() {
-    accountTable->clearContents();
-    accountTable->setRowCount(0);
+void AccountManager::applyAccountLoad(const AccountLoad &load) {
+    // The model keeps reading the current generation while the next one is
+    // built in the spare slot.
+    AccountGeneration &next = *spare;
+    next.reset();
+    next.snapshot = load.snapshot;
+    const QVector<FinanceDatabase::AccountRecord> &records = load.records;
+
+    next.superseded.assign(next.snapshot ? next.snapshot->size() : 0, false);
+    next.accounts.reserve(records.size());
+    for (const FinanceDatabase::AccountRecord &record : records) {
+        if (next.snapshot) {
+            size_t row = next.snapshot->find(record.id.toStdString());
+            if (row != AccountSnapshot::npos) {
+                next.superseded[row] = true;
+            }
+        }
 
-    for (const auto& account : allAccounts) {
-        QString accountId = QString::fromStdString(account->getID());
-        QString owner = QString::fromStdString(account->getOwner());
-        
-        if (account->isAdmin()) {
+        // One bad row (say, an id too short for an Account) is skipped
+        // rather than failing the whole load.
+        Account* account;
+        try {
+            account = next.arena.create<Account>(next.strings, record.owner.toStdString(), record.id.toStdString(),
+                                                 kNoMinimum, record.balance);
+        } catch (const std::invalid_argument &e) {
+            qWarning() << "Skipping account" << record.id << "-" << e.what();
             continue;
         }
+        account->setUsername(record.username.toStdString());
+        account->setEmail(record.email.toStdString());
+        account->setIsAdmin(record.isAdmin);
+        next.accounts.append(account);
+    }
 
-        if (isAdminUser || (owner.toLower() == currentUser.toLower())) {
-            int row = accountTable->rowCount();
-            accountTable->insertRow(row);
+    std::swap(current, spare);
+    updateAccountList();
+    // Nothing points into the previous generation any more.
+    spare->reset();
+    spare->snapshot.reset();
+}
 
-            QTableWidgetItem* idItem = new QTableWidgetItem(accountId);
-            QTableWidgetItem* ownerItem = new QTableWidgetItem(owner);
-            QTableWidgetItem* balanceItem = new QTableWidgetItem(QString::number(account->getCurrent().getDollars(), 'f', 2));
+void AccountManager::updateAccountList() {
+    // Snapshot rows are read straight from the mapping; only the accounts
+    // changed since it was written are materialized. Other users see the
+    // accounts held in their own name.
+    const std::string owner = session.displayName.toStdString();
+    const AccountSnapshot *snapshot = current->snapshot.get();
+    std::vector<uint32_t> snapshotRows;
+    if (snapshot) {
+        for (size_t row = 0; row < snapshot->size(); ++row) {
+            if (current->superseded[row] || snapshot->isAdmin(row)) {
+                continue;
+            }
+            if (session.isAdmin || snapshot->owner(row) == owner) {
+                snapshotRows.push_back(static_cast<uint32_t>(row));
+            }
+        }
+    }
 
-            accountTable->setItem(row, 0, idItem);
-            accountTable->setItem(row, 1, ownerItem);
-            accountTable->setItem(row, 2, balanceItem);
+    QList<const Account*> visible;
+    visible.reserve(current->accounts.size());
+    for (const Account* account : current->accounts) {
+        if (account->isAdmin()) {
+            continue;
+        }
+        if (session.isAdmin || account->getOwner() == owner) {
+            visible.append(account);
         }
     }
+
+    accountModel->setAccounts(snapshot, std::move(snapshotRows), visible);
 }
 
-void AccountManager::setUserAccess(const QString &username, bool isAdmin) {
-    currentUser = username;
-    isAdminUser = isAdmin;
-    userButton->setText(username);
+void AccountManager::setUserAccess(const Session &session) {
+    this->session = session;
+    userButton->setText(session.username);
     loadAccountsFromDatabase();
     
-    if (isAdmin) {
+    if (session.isAdmin) {
+        leaseIdNode();
+        accountFilter->show();
         accountTable->show();
         userViewWidget->hide();
-        updateAccountList();
     } else {
+        accountFilter->hide();
         accountTable->hide();
         userViewWidget->show();
-        displayAccountDetails(QString::fromStdString(getCurrentUserAccountId()));
+        displayAccountDetails(session.accountId);
     }
 }
 
-std::string AccountManager::getCurrentUserAccountId() {
-    for (const auto& account : allAccounts) {
-        if (QString::fromStdString(account->getUsername()).toLower() == currentUser.toLower()) {
-            return account->getID();
-        }
-    }
-    return "";
+void AccountManager::showBalance(const Money &balance) {
+    char balanceText[kMaxMoneyChars];
+    char* balanceEnd = balance.format(balanceText, balanceText + sizeof(balanceText), MoneyStyle::Plain);
+    accountBalanceLabel->setText("Current Balance: $" + QString::fromLatin1(balanceText, balanceEnd - balanceText));
 }
 
+// Loads the account and its history on the database worker. A newer request,
+// or a logout, makes displayedAccountId differ and the stale result is dropped.
 void AccountManager::displayAccountDetails(const QString &accountId) {
-    QSqlQuery accountQuery;
-    accountQuery.prepare("SELECT * FROM accounts WHERE id = :account_id");
-    accountQuery.bindValue(":account_id", accountId);
+    displayedAccountId = accountId;
+    if (transactionList->count() == 0) {
+        transactionList->addItem("Loading...");
+    }
+    worker->run([accountId](FinanceDatabase &db) {
+        AccountDetails details;
+        details.record = db.account(accountId);
+        if (details.record) {
+            details.postings = db.recentPostings(accountId, 10);
+        }
+        return details;
+    }).then(this, [this, accountId](const AccountDetails &details) {
+        if (accountId == displayedAccountId) {
+            renderAccountDetails(accountId, details);
+        }
+    });
+}
 
-    if (accountQuery.exec() && accountQuery.next()) {
-        QString owner = accountQuery.value("owner").toString();
-        QString email = accountQuery.value("email").toString();
-        double balance = accountQuery.value("balance").toDouble();
+void AccountManager::renderAccountDetails(const QString &accountId, const AccountDetails &details) {
+    const std::optional<FinanceDatabase::AccountRecord> &record = details.record;
+    if (!record) {
+        displayedAccountId.clear();
+    }
 
-        accountNameLabel->setText(owner);
+    if (record) {
+        accountNameLabel->setText(record->owner);
         accountIdLabel->setText("Account ID: " + accountId);
-        accountBalanceLabel->setText(QString("Current Balance: $%1").arg(balance, 0, 'f', 2));
-        accountEmailLabel->setText("Email: " + email);
-
-        QSqlQuery transactionQuery;
-        transactionQuery.prepare("SELECT * FROM transactions WHERE account_id = :account_id ORDER BY date DESC LIMIT 10");
-        transactionQuery.bindValue(":account_id", accountId);
+        showBalance(record->balance);
+        accountEmailLabel->setText("Email: " + record->email);
 
         transactionList->clear();
-        if (transactionQuery.exec()) {
-            while (transactionQuery.next()) {
-                QString date = transactionQuery.value("date").toString();
-                double amount = transactionQuery.value("amount").toDouble();
-                QString type = transactionQuery.value("type").toString();
-
-                QString transactionText = QString("%1 | %2 | $%3")
-                                              .arg(date)
-                                              .arg(type)
-                                              .arg(qAbs(amount), 0, 'f', 2);
-                QListWidgetItem *item = new QListWidgetItem(transactionText);
-                
-                if (amount < 0) {
-                    item->setForeground(Qt::red);
-                    transactionText = "- " + transactionText;
-                } else {
-                    item->setForeground(Qt::darkGreen);
-                    transactionText = "+ " + transactionText;
-                }
-                
-                item->setText(transactionText);
-                transactionList->addItem(item);
+        for (const FinanceDatabase::PostingRecord &posting : details.postings) {
+            char amountText[kMaxMoneyChars];
+            char* amountEnd = formatMoney(amountText, amountText + sizeof(amountText),
+                                          qAbs(posting.amount.getCents()), MoneyStyle::Plain);
+
+            QString transactionText = posting.date + " | " + posting.type + " | $"
+                                      + QString::fromLatin1(amountText, amountEnd - amountText);
+            QListWidgetItem *item = new QListWidgetItem(transactionText);
+
+            if (posting.amount < Money::fromCents(0)) {
+                item->setForeground(Qt::red);
+                transactionText = "- " + transactionText;
+            } else {
+                item->setForeground(Qt::darkGreen);
+                transactionText = "+ " + transactionText;
             }
+
+            item->setText(transactionText);
+            transactionList->addItem(item);
         }
 
-        if (isAdminUser) {
+        if (session.isAdmin) {
             userViewWidget->show();
         }
     } else {
@@ -288,18 +459,15 @@ void AccountManager::displayAccountDetails(const QString &accountId) {
     }
 }
 
-void AccountManager::showAccountDetails(int row, int column) {
-    Q_UNUSED(column);
-    QString accountId = accountTable->item(row, 0)->text();
-    displayAccountDetails(accountId);
+void AccountManager::showAccountDetails(const QModelIndex &index) {
+    displayAccountDetails(accountModel->accountId(accountProxy->mapToSource(index).row()));
 }
 
 void AccountManager::showCreateAccountForm() {
-    if (isAdminUser) {
+    if (session.isAdmin) {
         QDialog* dialog = setupAccountCreationDialog();
         if (dialog->exec() == QDialog::Accepted) {
             loadAccountsFromDatabase();
-            updateAccountList();
         }
         delete dialog;
     } else {
@@ -362,7 +530,7 @@ QDialog* AccountManager::setupAccountCreationDialog() {
     buttonLayout->addWidget(cancelButton);
     layout->addLayout(buttonLayout);
 
-    connect(createButton, &QPushButton::clicked, [dialog, inputs, this]() {
+    connect(createButton, &QPushButton::clicked, [dialog, inputs, createButton, this]() {
         QString firstName = inputs[0]->text().trimmed();
         QString lastName = inputs[1]->text().trimmed();
         QString username = inputs[2]->text().trimmed();
@@ -384,25 +552,56 @@ QDialog* AccountManager::setupAccountCreationDialog() {
         QString accountId = generateUniqueAccountId();
         std::string owner = (firstName + " " + lastName).toStdString();
         Money initial = Money::fromDollars(initialBalance);
-        Money minimum = Money::fromDollars(0);
-
-        Account* newAccount = new Account(owner, accountId.toStdString(), minimum, initial);
-        newAccount->setUsername(username.toStdString());
-        newAccount->setEmail(email.toStdString());
-        
-        QString password = QString::fromStdString(bank->generatePassword(owner, accountId.toStdString()));
-        newAccount->setPassword(password.toStdString());
-        newAccount->setIsAdmin(false);
-
-        saveAccountToDatabase(newAccount);
+        const QString password = QString::fromStdString(PasswordHasher::generatePassword());
+
+        // The KDF takes long enough to freeze the dialog, so it runs on the
+        // thread pool; closing the dialog meanwhile drops the result.
+        createButton->setEnabled(false);
+        createButton->setText("Creating...");
+        auto promise = std::make_shared<QPromise<QString>>();
+        QFuture<QString> hashed = promise->future();
+        promise->start();
+        QThreadPool::globalInstance()->start([promise, password]() {
+            // An exception must not escape a pool thread; hand it to the
+            // continuation instead, and finish either way.
+            try {
+                promise->addResult(QString::fromStdString(PasswordHasher::hash(password.toStdString())));
+            } catch (...) {
+                promise->setException(std::current_exception());
+            }
+            promise->finish();
+        });
+        auto restore = [dialog, createButton]() {
+            QMessageBox::warning(dialog, "Account Not Created", "The account could not be created. Please try again.");
+            createButton->setEnabled(true);
+            createButton->setText("Create");
+        };
+        hashed.then(dialog, [=](const QString &passwordHash) {
+            StringPool strings;
+            Account newAccount(strings, owner, accountId.toStdString(), Money::fromDollars(0), initial);
+            newAccount.setUsername(username.toStdString());
+            newAccount.setEmail(email.toStdString());
+            newAccount.setPassword(passwordHash.toStdString());
+            newAccount.setIsAdmin(false);
+
+            saveAccountToDatabase(&newAccount).then(dialog, [=](const QString &error) {
+                if (!error.isEmpty()) {
+                    QMessageBox::warning(dialog, "Account Not Created", "The account could not be saved:\n" + error);
+                    createButton->setEnabled(true);
+                    createButton->setText("Create");
+                    return;
+                }
 
-        QString message = QString("Account created successfully!\n\nAccount ID: %1\nUsername: %2\nPassword: %3")
-                              .arg(accountId)
-                              .arg(username)
-                              .arg(password);
-        QMessageBox::information(dialog, "Account Created", message);
+                // Only the hash is stored; this is the one time the password is shown.
+                QString message = QString("Account created successfully!\n\nAccount ID: %1\nUsername: %2\nPassword: %3")
+                                      .arg(accountId)
+                                      .arg(username)
+                                      .arg(password);
+                QMessageBox::information(dialog, "Account Created", message);
 
-        dialog->accept();
+                dialog->accept();
+            }).onFailed(dialog, restore);
+        }).onFailed(dialog, restore);
     });
 
     connect(cancelButton, &QPushButton::clicked, dialog, &QDialog::reject);
@@ -410,51 +609,82 @@ QDialog* AccountManager::setupAccountCreationDialog() {
     return dialog;
 }
 
-void AccountManager::saveAccountToDatabase(const Account* account) {
-    if (account->getOwner().empty() || account->getID().empty() || account->getUsername().empty()) {
-        qDebug() << "Owner, ID, or Username cannot be empty.";
-        return;
-    }
+QFuture<QString> AccountManager::saveAccountToDatabase(const Account* account) {
+    FinanceDatabase::AccountRecord record;
+    record.id = toQString(account->getID());
+    record.owner = toQString(account->getOwner());
+    record.username = toQString(account->getUsername());
+    record.email = toQString(account->getEmail());
+    record.password = QString::fromStdString(account->getPassword());
+    record.balance = account->getCurrent();
+    record.isAdmin = account->isAdmin();
+
+    return worker->run([record](FinanceDatabase &db) {
+        if (record.owner.isEmpty() || record.id.isEmpty() || record.username.isEmpty()) {
+            return QString("Owner, ID, or Username cannot be empty.");
+        }
+        if (db.insertAccount(record)) {
+            return QString();
+        }
+        qDebug() << "Error saving account:" << db.lastError();
+        return db.lastError().isEmpty() ? QString("unknown error") : db.lastError();
+    });
+}
 
-    QSqlQuery query;
-    query.prepare("INSERT OR REPLACE INTO accounts (id, owner, username, email, password, balance, is_admin) "
-                  "VALUES (:id, :owner, :username, :email, :password, :balance, :is_admin)");
-    query.bindValue(":id", QString::fromStdString(account->getID()));
-    query.bindValue(":owner", QString::fromStdString(account->getOwner()));
-    query.bindValue(":username", QString::fromStdString(account->getUsername()));
-    query.bindValue(":email", QString::fromStdString(account->getEmail()));
-    query.bindValue(":password", QString::fromStdString(account->getPassword()));
-    query.bindValue(":balance", account->getCurrent().getDollars());
-    query.bindValue(":is_admin", account->isAdmin());
-
-    if (!query.exec()) {
-        qDebug() << "Error saving account:" << query.lastError().text();
+// The node is leased from the database, so other processes writing to it
+// (the CLI, a second window) cannot mint the same ids. It is leased when an
+// admin logs in, well before the first account is created.
+void AccountManager::leaseIdNode() {
+    if (accountIds || leasingIdNode) {
+        return;
     }
+    leasingIdNode = true;
+    worker->run([](FinanceDatabase &db) {
+        std::optional<uint32_t> node = db.leaseIdNode();
+        if (!node) {
+            qWarning() << "Could not lease an id node:" << db.lastError();
+        }
+        return node;
+    }).then(this, [this](std::optional<uint32_t> node) {
+        leasingIdNode = false;
+        if (!accountIds) {
+            accountIds = std::make_unique<IdGenerator>(node.value_or(IdGenerator::defaultNode()));
+        }
+    }).onFailed(this, [this]() {
+        leasingIdNode = false;
+        qWarning() << "Could not lease an id node";
+    });
 }
 
 QString AccountManager::generateUniqueAccountId() {
-    QDateTime now = QDateTime::currentDateTime();
-    return now.toString("yyyyMMddHHmmsszzz");
+    if (!accountIds) {
+        qWarning() << "No id node leased yet; using the default node";
+        accountIds = std::make_unique<IdGenerator>(IdGenerator::defaultNode());
+    }
+    return QString::fromStdString(IdGenerator::format(accountIds->next()));
 }
 
 void AccountManager::clearData() {
-    accountTable->clearContents();
-    accountTable->setRowCount(0);
+    accountFilter->clear();
+    accountModel->clear();
     accountNameLabel->clear();
     accountIdLabel->clear();
     accountBalanceLabel->clear();
     accountEmailLabel->clear();
     transactionList->clear();
-    qDeleteAll(allAccounts);
-    allAccounts.clear();
+    // The model was cleared above; the snapshot stays for the next login.
+    current->reset();
+    spare->reset();
+    displayedAccountId.clear();
+    session = Session();
 }
 
-void AccountManager::onTransactionCompleted() {
-    loadAccountsFromDatabase();
-    
-    if (isAdminUser) {
-        updateAccountList();
-    } else {
-        displayAccountDetails(QString::fromStdString(getCurrentUserAccountId()));
+void AccountManager::onTransactionCompleted(const QVector<FinanceDatabase::BalanceRecord> &changes) {
+    for (const FinanceDatabase::BalanceRecord &change : changes) {
+        accountModel->setBalance(change.accountId, change.balance);
+        if (change.accountId == displayedAccountId) {
+            // The new posting belongs at the top of the history, so reload it.
+            displayAccountDetails(displayedAccountId);
+        }
     }
 }
\ No newline at end of file
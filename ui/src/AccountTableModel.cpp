@@ -0,0 +1,166 @@
+#include "AccountTableModel.h"
+#include <algorithm>
+#include "MoneyFormat.h"
+
+namespace {
+
+QString toQString(std::string_view text) {
+    return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+}
+
+char foldAscii(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// needle is already folded; haystack is folded byte by byte as it is scanned.
+bool containsFolded(std::string_view haystack, std::string_view needle) {
+    return std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                       [](char h, char n) { return foldAscii(h) == n; }) != haystack.end();
+}
+
+}
+
+AccountTableModel::AccountTableModel(QObject *parent)
+    : QAbstractTableModel(parent), snapshot(nullptr) {}
+
+int AccountTableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(snapshotRows.size()) + accounts.size();
+}
+
+int AccountTableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+std::string_view AccountTableModel::idAt(int row) const {
+    const int snapshotCount = static_cast<int>(snapshotRows.size());
+    return row < snapshotCount ? snapshot->id(snapshotRows[row]) : std::string_view(accounts[row - snapshotCount]->getID());
+}
+
+std::string_view AccountTableModel::ownerAt(int row) const {
+    const int snapshotCount = static_cast<int>(snapshotRows.size());
+    return row < snapshotCount ? snapshot->owner(snapshotRows[row])
+                               : std::string_view(accounts[row - snapshotCount]->getOwner());
+}
+
+Money AccountTableModel::balanceAt(int row) const {
+    auto update = balanceUpdates.constFind(row);
+    if (update != balanceUpdates.constEnd()) {
+        return *update;
+    }
+    const int snapshotCount = static_cast<int>(snapshotRows.size());
+    return row < snapshotCount ? snapshot->balance(snapshotRows[row]) : accounts[row - snapshotCount]->getCurrent();
+}
+
+QVariant AccountTableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (role == Qt::TextAlignmentRole && index.column() == BalanceColumn) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (index.column()) {
+    case IdColumn:
+        return toQString(idAt(index.row()));
+    case OwnerColumn:
+        return toQString(ownerAt(index.row()));
+    case BalanceColumn: {
+        char text[kMaxMoneyChars];
+        char *end = balanceAt(index.row()).format(text, text + sizeof(text), MoneyStyle::Plain);
+        return QString::fromLatin1(text, static_cast<int>(end - text));
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QVariant AccountTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case IdColumn: return QStringLiteral("Account ID");
+    case OwnerColumn: return QStringLiteral("Owner");
+    case BalanceColumn: return QStringLiteral("Balance");
+    default: return QVariant();
+    }
+}
+
+void AccountTableModel::setAccounts(const AccountSnapshot *snapshot, std::vector<uint32_t> snapshotRows,
+                                    QList<const Account*> accounts) {
+    beginResetModel();
+    this->snapshot = snapshot;
+    this->snapshotRows = std::move(snapshotRows);
+    this->accounts = std::move(accounts);
+    balanceUpdates.clear();
+    endResetModel();
+}
+
+void AccountTableModel::clear() {
+    setAccounts(nullptr, {}, {});
+}
+
+void AccountTableModel::setBalance(const QString &accountId, const Money &balance) {
+    const std::string id = accountId.toStdString();
+    int row = -1;
+    for (int i = 0; i < accounts.size() && row < 0; ++i) {
+        if (accounts[i]->getID() == id) {
+            row = static_cast<int>(snapshotRows.size()) + i;
+        }
+    }
+    if (row < 0 && snapshot) {
+        size_t snapshotRow = snapshot->find(id);
+        auto it = std::lower_bound(snapshotRows.begin(), snapshotRows.end(), snapshotRow);
+        if (snapshotRow != AccountSnapshot::npos && it != snapshotRows.end() && *it == snapshotRow) {
+            row = static_cast<int>(it - snapshotRows.begin());
+        }
+    }
+    if (row < 0) {
+        return;
+    }
+    balanceUpdates.insert(row, balance);
+    QModelIndex cell = index(row, BalanceColumn);
+    emit dataChanged(cell, cell, {Qt::DisplayRole});
+}
+
+QString AccountTableModel::accountId(int row) const {
+    return row >= 0 && row < rowCount() ? toQString(idAt(row)) : QString();
+}
+
+bool AccountTableModel::lessThan(int left, int right, int column) const {
+    switch (column) {
+    case OwnerColumn: return ownerAt(left) < ownerAt(right);
+    case BalanceColumn: return balanceAt(left) < balanceAt(right);
+    default: return idAt(left) < idAt(right);
+    }
+}
+
+bool AccountTableModel::contains(int row, std::string_view foldedText) const {
+    return containsFolded(idAt(row), foldedText) || containsFolded(ownerAt(row), foldedText);
+}
+
+AccountFilterProxy::AccountFilterProxy(QObject *parent) : QSortFilterProxyModel(parent) {
+    // Balance edits should not make rows jump while the admin is looking.
+    setDynamicSortFilter(false);
+}
+
+void AccountFilterProxy::setFilterText(const QString &text) {
+    filterText = text.trimmed().toUtf8().toStdString();
+    std::transform(filterText.begin(), filterText.end(), filterText.begin(), foldAscii);
+    invalidateFilter();
+}
+
+bool AccountFilterProxy::lessThan(const QModelIndex &left, const QModelIndex &right) const {
+    const auto *model = static_cast<const AccountTableModel*>(sourceModel());
+    return model->lessThan(left.row(), right.row(), left.column());
+}
+
+bool AccountFilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+    Q_UNUSED(sourceParent);
+    if (filterText.empty()) {
+        return true;
+    }
+    return static_cast<const AccountTableModel*>(sourceModel())->contains(sourceRow, filterText);
+}
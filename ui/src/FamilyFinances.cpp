@@ -1,4 +1,5 @@
 #include "FamilyFinances.h"
+#include "DatabaseWorker.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QStackedWidget>
@@ -14,7 +15,7 @@
 #include <QDebug>
 
 FamilyFinances::FamilyFinances(QWidget *parent)
-    : QMainWindow(parent), bank(new Bank()), isAdminUser(false) {
+    : QMainWindow(parent), bank(new Bank()), worker(nullptr) {
     setWindowTitle("Family Finances");
 
     if (!initializeDatabase()) {
@@ -22,10 +23,12 @@ FamilyFinances::FamilyFinances(QWidget *parent)
         exit(1);
     }
 
-    loginPage = new LoginPage(this);
+    // Logins, transfers, account and history loads run here, off the GUI thread.
+    worker = new DatabaseWorker(QSqlDatabase::database().databaseName(), ConnectionProfile::WalNormal);
+    loginPage = new LoginPage(worker, this);
     bankWidget = new QWidget(this);
-    accountManager = new AccountManager(bank, this);
-    transactionManager = new TransactionManager(bank, this);
+    accountManager = new AccountManager(bank, worker, QSqlDatabase::database().databaseName(), this);
+    transactionManager = new TransactionManager(worker, this);
 
     QStackedWidget *stackedWidget = new QStackedWidget(this);
     stackedWidget->addWidget(loginPage);
@@ -41,6 +44,7 @@ FamilyFinances::FamilyFinances(QWidget *parent)
 }
 
 FamilyFinances::~FamilyFinances() {
+    delete worker;
     delete bank;
     QSqlDatabase::database().close();
 }
@@ -50,22 +54,27 @@ void FamilyFinances::closeEvent(QCloseEvent *event) {
     event->accept();
 }
 
-void FamilyFinances::onLoginSuccessful(const QString &username, bool isAdmin) {
-    setUserAccess(username, isAdmin);
+void FamilyFinances::onLoginSuccessful(const Session &session) {
+    setUserAccess(session);
     static_cast<QStackedWidget*>(centralWidget())->setCurrentWidget(bankWidget);
 }
 
 void FamilyFinances::onLogoutRequested() {
     qDebug() << "Logout requested";
     static_cast<QStackedWidget*>(centralWidget())->setCurrentWidget(loginPage);
-    currentUser.clear();
-    isAdminUser = false;
+    session = Session();
     loginPage->clearInputs();
     accountManager->clearData();
     transactionManager->clearData();
 }
 
 bool FamilyFinances::initializeDatabase() {
+    // main() normally opens, configures and migrates the connection already;
+    // replacing it here would drop its connection profile.
+    if (QSqlDatabase::contains() && QSqlDatabase::database().isOpen()) {
+        return true;
+    }
+
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
     db.setDatabaseName("/Users/vikashkumar/FamilyFinances/familyfinances.db");
 
@@ -78,11 +87,10 @@ bool FamilyFinances::initializeDatabase() {
     return true;
 }
 
-void FamilyFinances::setUserAccess(const QString &username, bool isAdmin) {
-    currentUser = username;
-    isAdminUser = isAdmin;
-    accountManager->setUserAccess(username, isAdmin);
-    transactionManager->setUserAccess(username, isAdmin);
+void FamilyFinances::setUserAccess(const Session &session) {
+    this->session = session;
+    accountManager->setUserAccess(session);
+    transactionManager->setUserAccess(session);
 }
 
 void FamilyFinances::setupUI() {
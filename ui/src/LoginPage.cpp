@@ -1,14 +1,15 @@
 #include "LoginPage.h"
+#include "DatabaseWorker.h"
+#include "PasswordHasher.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMessageBox>
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QDebug>
 #include <QFrame>
+#include <QThreadPool>
 
-LoginPage::LoginPage(QWidget *parent) : QWidget(parent) {
+LoginPage::LoginPage(DatabaseWorker *worker, QWidget *parent) : QWidget(parent), worker(worker) {
     setupUI();
     connect(loginButton, &QPushButton::clicked, this, &LoginPage::attemptLogin);
 }
@@ -49,39 +50,70 @@ void LoginPage::resizeEvent(QResizeEvent *event) {
     layout()->update();
 }
 
-void LoginPage::attemptLogin() {
-    QString username = usernameInput->text();
-    QString password = passwordInput->text();
-
-    if (authenticateUser(username, password)) {
-        bool isAdmin = checkIfAdmin(username);
-        emit loginSuccessful(username, isAdmin);
-    } else {
-        QMessageBox::warning(this, "Login Failed", "Invalid username or password.");
-    }
-}
+namespace {
 
-bool LoginPage::authenticateUser(const QString &username, const QString &password) {
-    QSqlQuery query;
-    query.prepare("SELECT password FROM accounts WHERE username = :username");
-    query.bindValue(":username", username);
+using StoredLogin = std::optional<FinanceDatabase::LoginRecord>;
 
-    if (query.exec() && query.next()) {
-        QString storedPassword = query.value(0).toString();
-        return (storedPassword == password);
-    }
+struct LoginCheck {
+    bool authenticated = false;
+    Session session;
+    // Replaces the stored credential when it is plaintext or below the
+    // current cost.
+    QString upgradedHash;
+};
 
-    return false;
 }
 
-bool LoginPage::checkIfAdmin(const QString &username) {
-    QSqlQuery query;
-    query.prepare("SELECT is_admin FROM accounts WHERE username = :username");
-    query.bindValue(":username", username);
+void LoginPage::attemptLogin() {
+    QString username = usernameInput->text();
+    QString password = passwordInput->text();
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toBool();
-    }
+    setPending(true);
+    // The lookup runs on the database worker and the KDF on the global
+    // thread pool, so neither the GUI nor other queries wait for the hash.
+    worker->run([username](FinanceDatabase &database) {
+        return database.login(username);
+    }).then(QThreadPool::globalInstance(), [username, password](const StoredLogin &stored) {
+        const std::string candidate = password.toStdString();
+        // An unknown user is checked against an empty credential, which
+        // costs as much as a real one and never matches.
+        const std::string credential = stored ? stored->credential.toStdString() : std::string();
+        LoginCheck check;
+        check.authenticated = PasswordHasher::verify(candidate, credential);
+        if (check.authenticated) {
+            check.session.accountId = stored->accountId;
+            check.session.username = username;
+            check.session.displayName = stored->owner;
+            check.session.isAdmin = stored->isAdmin;
+        }
+        if (check.authenticated && PasswordHasher::needsRehash(credential)) {
+            check.upgradedHash = QString::fromStdString(PasswordHasher::hash(candidate));
+        }
+        return check;
+    }).then(this, [this, username](const LoginCheck &check) {
+        setPending(false);
+        if (!check.upgradedHash.isEmpty()) {
+            const QString hash = check.upgradedHash;
+            worker->run([username, hash](FinanceDatabase &database) {
+                if (!database.setPassword(username, hash)) {
+                    qDebug() << "Could not upgrade the stored password:" << database.lastError();
+                }
+            });
+        }
+        if (check.authenticated) {
+            emit loginSuccessful(check.session);
+        } else {
+            QMessageBox::warning(this, "Login Failed", "Invalid username or password.");
+        }
+    }).onFailed(this, [this]() {
+        setPending(false);
+        QMessageBox::warning(this, "Login Failed", "Could not check the credentials. Please try again.");
+    });
+}
 
-    return false;
+void LoginPage::setPending(bool pending) {
+    usernameInput->setEnabled(!pending);
+    passwordInput->setEnabled(!pending);
+    loginButton->setEnabled(!pending);
+    loginButton->setText(pending ? "Signing in..." : "Login");
 }
@@ -1,17 +1,16 @@
 #include "TransactionManager.h"
+#include "DatabaseWorker.h"
+#include "FinanceDatabase.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QGroupBox>
 #include <QMessageBox>
-#include <QSqlError>
-#include <QSqlQuery>
-#include <QDateTime>
 #include <QDebug>
 #include <QLabel>
 
-TransactionManager::TransactionManager(Bank *bank, QWidget *parent)
-    : QWidget(parent), bank(bank), isAdminUser(false) {
+TransactionManager::TransactionManager(DatabaseWorker *worker, QWidget *parent)
+    : QWidget(parent), worker(worker) {
     setupUI();
     setupConnections();
 }
@@ -96,13 +95,11 @@ void TransactionManager::setupConnections() {
     connect(transferButton, &QPushButton::clicked, this, &TransactionManager::performTransaction);
 }
 
-void TransactionManager::setUserAccess(const QString &username, bool isAdmin) {
-    currentUser = username;
-    isAdminUser = isAdmin;
+void TransactionManager::setUserAccess(const Session &session) {
+    this->session = session;
 
-    if (!isAdminUser) {
-        QString userAccountId = getUserAccountId(username);
-        sourceInput->setText(userAccountId);
+    if (!session.isAdmin) {
+        sourceInput->setText(session.accountId);
         sourceInput->setReadOnly(true);
     } else {
         sourceInput->clear();
@@ -113,6 +110,15 @@ void TransactionManager::setUserAccess(const QString &username, bool isAdmin) {
     amountInput->clear();
 }
 
+namespace {
+
+struct TransferOutcome {
+    FinanceDatabase::TransferStatus status = FinanceDatabase::TransferStatus::Failed;
+    QVector<FinanceDatabase::BalanceRecord> balances;
+};
+
+}
+
 void TransactionManager::performTransaction() {
     QString sourceId = sourceInput->text();
     QString destId = destInput->text();
@@ -131,114 +137,79 @@ void TransactionManager::performTransaction() {
         return;
     }
 
-    QSqlDatabase::database().transaction();
-
-    QSqlQuery query;
-    
-    // Check source account
-    query.prepare("SELECT balance FROM accounts WHERE id = :id");
-    query.bindValue(":id", sourceId);
-    if (!query.exec() || !query.next()) {
-        QSqlDatabase::database().rollback();
-        statusLabel->setText("Error: Invalid source account ID.");
-        return;
-    }
-    double sourceBalance = query.value("balance").toDouble();
-    
-    // Check destination account
-    query.prepare("SELECT id FROM accounts WHERE id = :id");
-    query.bindValue(":id", destId);
-    if (!query.exec() || !query.next()) {
-        QSqlDatabase::database().rollback();
-        statusLabel->setText("Error: Invalid destination account ID.");
-        return;
-    }
-    
-    // Check for sufficient funds
-    if (sourceBalance < amount) {
-        QSqlDatabase::database().rollback();
-        statusLabel->setText("Error: Insufficient funds in source account.");
-        return;
-    }
-    
-    // Update source account
-    query.prepare("UPDATE accounts SET balance = balance - :amount WHERE id = :id");
-    query.bindValue(":amount", amount);
-    query.bindValue(":id", sourceId);
-    if (!query.exec()) {
-        QSqlDatabase::database().rollback();
-        statusLabel->setText("Error: Failed to update source account.");
-        return;
-    }
-    
-    // Update destination account
-    query.prepare("UPDATE accounts SET balance = balance + :amount WHERE id = :id");
-    query.bindValue(":amount", amount);
-    query.bindValue(":id", destId);
-    if (!query.exec()) {
-        QSqlDatabase::database().rollback();
-        statusLabel->setText("Error: Failed to update destination account.");
-        return;
-    }
-    
-    // Record transaction for source account
-    query.prepare("INSERT INTO transactions (account_id, amount, type, date) VALUES (:source_id, :amount, :type, :date)");
-    query.bindValue(":source_id", sourceId);
-    query.bindValue(":amount", -amount);
-    query.bindValue(":type", "TRANSFER");
-    query.bindValue(":date", QDateTime::currentDateTime().toString(Qt::ISODate));
-    if (!query.exec()) {
-        QSqlDatabase::database().rollback();
-        qDebug() << "Error inserting source transaction:" << query.lastError().text();
-        statusLabel->setText("Error: Failed to record source transaction.");
-        return;
-    }
-    
-    // Record transaction for destination account
-    query.prepare("INSERT INTO transactions (account_id, amount, type, date) VALUES (:dest_id, :amount, :type, :date)");
-    query.bindValue(":dest_id", destId);
-    query.bindValue(":amount", amount);
-    query.bindValue(":type", "TRANSFER");
-    query.bindValue(":date", QDateTime::currentDateTime().toString(Qt::ISODate));
-    if (!query.exec()) {
-        QSqlDatabase::database().rollback();
-        qDebug() << "Error inserting destination transaction:" << query.lastError().text();
-        statusLabel->setText("Error: Failed to record destination transaction.");
-        return;
-    }
+    // The commit (and its fsync) happens on the database worker; the form
+    // stays locked until it reports back.
+    setPending(true);
+    const Money transferAmount = Money::fromDollars(amount);
+    worker->run([sourceId, destId, transferAmount](FinanceDatabase &db) {
+        TransferOutcome outcome;
+        outcome.status = db.transfer(sourceId, destId, transferAmount);
+        if (outcome.status == FinanceDatabase::TransferStatus::Ok) {
+            for (const QString &accountId : {sourceId, destId}) {
+                if (std::optional<Money> balance = db.balance(accountId)) {
+                    outcome.balances.append({accountId, *balance});
+                }
+            }
+        }
+        return outcome;
+    }).then(this, [this](const TransferOutcome &outcome) {
+        setPending(false);
+        switch (outcome.status) {
+        case FinanceDatabase::TransferStatus::InvalidAmount:
+            statusLabel->setText("Error: Invalid amount. Please enter a positive number.");
+            return;
+        case FinanceDatabase::TransferStatus::SameAccount:
+            statusLabel->setText("Error: Source and destination must be different accounts.");
+            return;
+        case FinanceDatabase::TransferStatus::UnknownSource:
+            statusLabel->setText("Error: Invalid source account ID.");
+            return;
+        case FinanceDatabase::TransferStatus::UnknownDestination:
+            statusLabel->setText("Error: Invalid destination account ID.");
+            return;
+        case FinanceDatabase::TransferStatus::InsufficientFunds:
+            statusLabel->setText("Error: Insufficient funds in source account.");
+            return;
+        case FinanceDatabase::TransferStatus::Failed:
+            statusLabel->setText("Error: Transaction failed. Please try again.");
+            return;
+        case FinanceDatabase::TransferStatus::Ok:
+            break;
+        }
 
-    if (QSqlDatabase::database().commit()) {
         statusLabel->setText("Transaction completed successfully.");
-        
+
         // Clear inputs
-        if (!isAdminUser) {
+        if (!session.isAdmin) {
             destInput->clear();
         } else {
             sourceInput->clear();
             destInput->clear();
         }
         amountInput->clear();
-        
+
         // Emit the signal to notify that a transaction has been completed
-        emit transactionCompleted();
-    } else {
-        QSqlDatabase::database().rollback();
+        emit transactionCompleted(outcome.balances);
+    }).onFailed(this, [this]() {
+        setPending(false);
         statusLabel->setText("Error: Transaction failed. Please try again.");
-    }
+    });
 }
 
-QString TransactionManager::getUserAccountId(const QString &username) {
-    QSqlQuery query;
-    query.prepare("SELECT id FROM accounts WHERE username = :username");
-    query.bindValue(":username", username);
-    
-    if (query.exec() && query.next()) {
-        return query.value("id").toString();
+void TransactionManager::setPending(bool pending) {
+    transferButton->setEnabled(!pending);
+    destInput->setReadOnly(pending);
+    amountInput->setReadOnly(pending);
+    if (session.isAdmin) {
+        sourceInput->setReadOnly(pending);
+    }
+    if (pending) {
+        statusLabel->setText("Processing transfer...");
     }
-    return "";
 }
 
 void TransactionManager::clearData() {
+    session = Session();
     sourceInput->clear();
     destInput->clear();
     amountInput->clear();